@@ -0,0 +1,146 @@
+// Group : I
+// Author: Brandon Collings
+// Email: brandon.l.collings@okstate.edu
+// Date: 10/19/2026
+// Description: Scaling benchmark for serial vs parallel deadlock detection on large generated networks, then
+// the generic vector detector against the compile-time specialized one on the fixed 8-intersection chain.
+// Usage: ./bench_detect [trains] [intersections] [max_threads]
+
+#include "detect_deadlock.h"
+#include "thread_pool.h"
+#include "detect_fixed.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <numeric>
+
+using namespace std;
+
+struct Scenario {
+    string name;
+    vector<vector<int>> allocation;
+    vector<vector<int>> request;
+    vector<int> available;
+};
+
+// Trains are split into one level per intersection. Level l fills intersection l and asks for one
+// slot of l+1, so every train can only finish after the next level has, and the serial loop needs
+// one pass per level. With close_cycle the last level asks for intersection 0 and nothing finishes.
+Scenario make_levels(int n, int m, bool close_cycle) {
+    Scenario s;
+    s.name = close_cycle ? "level cycle (deadlocked)" : "level chain (safe)";
+    s.allocation.assign(n, vector<int>(m, 0));
+    s.request.assign(n, vector<int>(m, 0));
+    s.available.assign(m, 0);
+
+    for (int i = 0; i < n; i++) {
+        int level = (long)i * m / n;
+        s.allocation[i][level] = 1;
+        if (level + 1 < m) {
+            s.request[i][level + 1] = 1;
+        } else if (close_cycle) {
+            s.request[i][0] = 1;
+        }
+    }
+    return s;
+}
+
+double time_ms(const function<bool()>& fn, bool& result) {
+    double best = 1e300;
+    for (int rep = 0; rep < 3; rep++) {
+        auto start = chrono::steady_clock::now();
+        result = fn();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if (ms < best) best = ms;
+    }
+    return best;
+}
+
+// Per-call cost on the 8x8 chain: vector version, dispatcher (copies the scope into bit masks
+// first, as the server does), and the specialization on a ready-made table
+void run_fixed_comparison() {
+    const int iterations = 200000;
+    cout << "\nFixed 8-train / 8-intersection chain, ns per check (" << iterations << " checks)\n";
+    for (bool close_cycle : {false, true}) {
+        Scenario s = make_levels(8, 8, close_cycle);
+        vector<int> trains(8), resources(8);
+        iota(trains.begin(), trains.end(), 0);
+        iota(resources.begin(), resources.end(), 0);
+        FixedResourceTable<8, 8> table;
+        for (int i = 0; i < 8; i++) {
+            for (int j = 0; j < 8; j++) {
+                table.allocation[i] |= (uint64_t)s.allocation[i][j] << j;
+                table.request[i] |= (uint64_t)s.request[i][j] << j;
+            }
+        }
+        for (int j = 0; j < 8; j++) table.available[j] = s.available[j];
+
+        bool generic_result, dispatch_result, fixed_result;
+        double generic_ms = time_ms([&] {
+            bool r = false;
+            for (int k = 0; k < iterations; k++) r ^= detect_deadlock(s.allocation, s.request, s.available, trains, resources);
+            return r;
+        }, generic_result);
+        double dispatch_ms = time_ms([&] {
+            bool r = false;
+            for (int k = 0; k < iterations; k++) r ^= detect_deadlock_dispatch(s.allocation, s.request, s.available, trains, resources);
+            return r;
+        }, dispatch_result);
+        double fixed_ms = time_ms([&] {
+            bool r = false;
+            for (int k = 0; k < iterations; k++) {
+                asm volatile("" : "+m"(table)); // keep the call from being hoisted out of the loop
+                r ^= detect_deadlock(table);
+            }
+            return r;
+        }, fixed_result);
+
+        cout << "  " << s.name << "\n" << setprecision(1)
+             << "    generic     " << setw(8) << generic_ms * 1e6 / iterations << " ns\n"
+             << "    dispatch    " << setw(8) << dispatch_ms * 1e6 / iterations << " ns\n"
+             << "    fixed<8,8>  " << setw(8) << fixed_ms * 1e6 / iterations << " ns  speedup="
+             << generic_ms / fixed_ms << "x"
+             << (generic_result == fixed_result && generic_result == dispatch_result ? "" : "  MISMATCH") << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? stoi(argv[1]) : 20000;
+    int m = argc > 2 ? stoi(argv[2]) : 200;
+    int max_threads = argc > 3 ? stoi(argv[3]) : (int)thread::hardware_concurrency();
+    if (max_threads < 1) max_threads = 1;
+
+    vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    vector<Scenario> scenarios = {make_levels(n, m, false), make_levels(n, m, true)};
+
+    cout << "Deadlock detection scaling: " << n << " trains, " << m << " intersections, best of 3\n";
+    for (const Scenario& s : scenarios) {
+        bool serial_result;
+        double serial_ms = time_ms([&] { return detect_deadlock(s.allocation, s.request, s.available); }, serial_result);
+
+        cout << "\n" << s.name << "\n";
+        cout << "  serial            " << fixed << setprecision(2) << setw(10) << serial_ms << " ms  deadlock=" << serial_result << "\n";
+
+        for (int threads : thread_counts) {
+            ThreadPool pool(threads);
+            bool parallel_result;
+            double parallel_ms = time_ms([&] {
+                return detect_deadlock_parallel(s.allocation, s.request, s.available, pool);
+            }, parallel_result);
+
+            cout << "  parallel x" << setw(3) << threads << "    " << setw(10) << parallel_ms << " ms  deadlock=" << parallel_result
+                 << "  speedup=" << setprecision(1) << serial_ms / parallel_ms << "x"
+                 << (parallel_result == serial_result ? "" : "  MISMATCH") << setprecision(2) << "\n";
+        }
+    }
+
+    run_fixed_comparison();
+    return 0;
+}
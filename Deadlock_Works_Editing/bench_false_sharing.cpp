@@ -0,0 +1,125 @@
+// Group : I
+// Author: Samuel Shankle
+// Email: samuel.shankle@okstate.edu
+// Date: 10/19/2026
+// Description: False-sharing benchmark for the shared intersection table. Forks one process per intersection, each
+// locking, updating and releasing only its own intersection, once with the old packed layout (name, lock and
+// holders side by side, neighbours sharing cache lines) and once with the hot/cold split from sync.h.
+// Independent intersections should scale with processes; any slowdown in the packed run is cache-line ping-pong.
+// Usage: ./bench_false_sharing [processes] [iterations]
+
+#include "sync.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <ctime>
+#include <new>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+// The layout before the split: every field of an intersection in one packed struct
+struct PackedIntersection {
+    char name[MAX_INTERSECTION_NAME_LENGTH];
+    int capacity;
+    int lock_type;
+    pthread_mutex_t mutex;
+    int num_holding_trains;
+    int holding_trains[MAX_TRAINS_AT_INTERSECTION];
+};
+
+static long now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+// Only for the packed layout; SharedMemory's constructor already makes its mutexes process-shared
+static void init_shared_mutex(pthread_mutex_t* mutex) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+// One grant + release on the process's own intersection, the same writes the server makes
+template <typename Lock>
+static void hammer(Lock* lock, const int* capacity, int train_id, long iterations) {
+    for (long i = 0; i < iterations; ++i) {
+        pthread_mutex_lock(&lock->mutex);
+        if (lock->num_holding_trains < *capacity) {
+            lock->holding_trains[lock->num_holding_trains++] = train_id;
+            lock->num_holding_trains--;
+        }
+        pthread_mutex_unlock(&lock->mutex);
+    }
+}
+
+// Runs `processes` children over the mapped table and returns aggregate operations per second
+template <typename Setup, typename Work>
+static double run_case(int processes, long iterations, Setup setup, Work work) {
+    setup();
+    long start = now_ns();
+    for (int p = 0; p < processes; ++p) {
+        if (fork() == 0) {
+            work(p);
+            _exit(0);
+        }
+    }
+    while (wait(nullptr) > 0) {
+    }
+    double elapsed_s = (now_ns() - start) / 1e9;
+    return processes * iterations / elapsed_s;
+}
+
+int main(int argc, char* argv[]) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int processes = argc > 1 ? stoi(argv[1]) : (int)max(2L, min(cpus, (long)MAX_INTERSECTIONS));
+    long iterations = argc > 2 ? stol(argv[2]) : 2000000;
+    if (processes > MAX_INTERSECTIONS) processes = MAX_INTERSECTIONS;
+
+    // The split table starts on a cache line boundary after the packed one, as it does in its own segment
+    size_t split_offset = (sizeof(PackedIntersection) * MAX_INTERSECTIONS + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+    size_t size = split_offset + sizeof(SharedMemory);
+    void* arena = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (arena == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    PackedIntersection* packed = (PackedIntersection*)arena;
+    SharedMemory* split = new ((char*)arena + split_offset) SharedMemory();
+
+    cout << "=== False sharing: " << processes << " processes x " << iterations << " grant/release, "
+         << cpus << " CPUs ===" << endl;
+    cout << "packed intersection " << sizeof(PackedIntersection) << " bytes, split lock "
+         << sizeof(IntersectionLock) << " bytes (aligned " << alignof(IntersectionLock) << ")" << endl;
+
+    double packed_rate = run_case(processes, iterations, [&] {
+        for (int i = 0; i < processes; ++i) {
+            packed[i] = PackedIntersection();
+            packed[i].capacity = 2;
+            init_shared_mutex(&packed[i].mutex);
+        }
+    }, [&](int p) {
+        hammer(&packed[p], &packed[p].capacity, p + 1, iterations);
+    });
+
+    double split_rate = run_case(processes, iterations, [&] {
+        for (int i = 0; i < processes; ++i) {
+            split->intersections[i].capacity = 2;
+        }
+    }, [&](int p) {
+        hammer(&split->locks[p], &split->intersections[p].capacity, p + 1, iterations);
+    });
+
+    cout << fixed << setprecision(2)
+         << "packed: " << packed_rate / 1e6 << " M ops/s" << endl
+         << "split:  " << split_rate / 1e6 << " M ops/s (" << split_rate / packed_rate << "x)" << endl;
+    if (cpus < 2) cout << "Note: one CPU, so no two processes touch a line at the same time; expect ~1x" << endl;
+
+    munmap(arena, size);
+    return 0;
+}
@@ -0,0 +1,356 @@
+// Group : I
+// Author: Samuel Shankle
+// Email: samuel.shankle@okstate.edu
+// Date: 10/19/2026
+// Description: Microbenchmarks for the hot paths: Logger::log, find_intersection_index, acquire/release,
+// detect_deadlock at several sizes and parseTrains on a large file. Every case is calibrated to a minimum sample
+// time, warmed up, then sampled repeatedly; the median ns/op is the headline and min/mean/stddev show the noise.
+// Results can be written as JSON and compared against a stored baseline; a case slower than the baseline by more
+// than the threshold (median and fastest sample alike) fails the run with exit status 2.
+// Usage: ./bench_micro [--filter=SUBSTR] [--samples=N] [--min-sample-ms=MS] [--json=PATH]
+//                      [--baseline=PATH] [--threshold=PCT]
+
+#include "log.h"
+#include "sync.h"
+#include "detect_deadlock.h"
+#include "parser.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <fcntl.h>
+
+using namespace std;
+
+#define WARMUP_SAMPLES 2
+
+struct BenchCase {
+    string name;
+    function<void(long)> run; // runs the operation n times
+};
+
+struct CaseResult {
+    string name;
+    long iterations;          // per sample
+    vector<double> ns_per_op; // one per sample
+    double median, min, mean, stddev;
+};
+
+static long now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+// Keeps the compiler from dropping a result
+static volatile long sink;
+
+// ---------------------------------------------------------------- fixtures
+
+static string scratch_dir;
+
+struct LoggerFixture {
+    int sim_time = 0;
+    pthread_mutex_t time_mutex;
+    Logger* logger;
+
+    LoggerFixture(const string& name, const LogOptions& options) {
+        pthread_mutex_init(&time_mutex, nullptr);
+        logger = new Logger(scratch_dir + "/" + name, &sim_time, &time_mutex, true, options);
+    }
+    ~LoggerFixture() {
+        delete logger;
+        pthread_mutex_destroy(&time_mutex);
+    }
+};
+
+// Fifty intersections like the simulator's table: capacity 1 (mutex) and 3 (ticket semaphore) alternate
+static SharedMemory* make_shared_memory() {
+    SharedMemory* shm = new SharedMemory();
+    for (int i = 0; i < MAX_INTERSECTIONS; ++i) {
+        int capacity = i % 2 == 0 ? 1 : 3;
+        snprintf(shm->intersections[i].name, MAX_INTERSECTION_NAME_LENGTH, "Intersection%d", i + 1);
+        shm->intersections[i].capacity = capacity;
+        shm->intersections[i].lock_type = capacity == 1 ? 1 : capacity;
+        ticket_init(&shm->semaphores[i], capacity);
+    }
+    return shm;
+}
+
+struct Matrices {
+    vector<vector<int>> allocation, request;
+    vector<int> available;
+};
+
+// The level chain of bench_detect: safe, but the serial loop needs one pass per level
+static Matrices make_levels(int n, int m) {
+    Matrices s;
+    s.allocation.assign(n, vector<int>(m, 0));
+    s.request.assign(n, vector<int>(m, 0));
+    s.available.assign(m, 0);
+    for (int i = 0; i < n; i++) {
+        int level = (long)i * m / n;
+        s.allocation[i][level] = 1;
+        if (level + 1 < m) s.request[i][level + 1] = 1;
+    }
+    return s;
+}
+
+static string write_trains_file(int trains, int hops) {
+    string path = scratch_dir + "/trains_" + to_string(trains) + ".txt";
+    ofstream out(path);
+    for (int t = 0; t < trains; t++) {
+        out << "Train" << t + 1 << ":";
+        for (int h = 0; h < hops; h++) out << (h ? "," : "") << "Intersection" << (t * 7 + h * 13) % 50 + 1;
+        out << "\n";
+    }
+    return path;
+}
+
+static vector<BenchCase> make_cases() {
+    vector<BenchCase> cases;
+
+    cases.push_back({"logger/log_direct", [](long n) {
+        static LoggerFixture fixture("direct.log", LogOptions());
+        for (long i = 0; i < n; i++) fixture.logger->log_server("Granted IntersectionA to Train7");
+    }});
+    cases.push_back({"logger/log_segments", [](long n) {
+        static LogOptions options = [] {
+            LogOptions o;
+            o.segments = true;
+            o.run_id = "bench";
+            return o;
+        }();
+        static LoggerFixture fixture("segments.log", options);
+        for (long i = 0; i < n; i++) fixture.logger->log_server("Granted IntersectionA to Train7");
+    }});
+
+    static SharedMemory* shm = make_shared_memory();
+    cases.push_back({"sync/find_intersection_index_first", [](long n) {
+        string name = "Intersection1";
+        for (long i = 0; i < n; i++) sink = find_intersection_index(name, shm);
+    }});
+    cases.push_back({"sync/find_intersection_index_last", [](long n) {
+        string name = "Intersection50";
+        for (long i = 0; i < n; i++) sink = find_intersection_index(name, shm);
+    }});
+    cases.push_back({"sync/find_intersection_index_miss", [](long n) {
+        string name = "IntersectionZ";
+        for (long i = 0; i < n; i++) sink = find_intersection_index(name, shm);
+    }});
+
+    static vector<vector<int>> request(1, vector<int>(MAX_INTERSECTIONS, 0));
+    cases.push_back({"sync/acquire_release_mutex", [](long n) {
+        string name = "Intersection1";
+        for (long i = 0; i < n; i++) {
+            handle_acquire_request(1, name, shm, request);
+            handle_release_request(1, name, shm);
+        }
+    }});
+    cases.push_back({"sync/acquire_release_semaphore", [](long n) {
+        string name = "Intersection2";
+        for (long i = 0; i < n; i++) {
+            handle_acquire_request(1, name, shm, request);
+            handle_release_request(1, name, shm);
+        }
+    }});
+
+    int sizes[][2] = {{10, 10}, {100, 50}, {1000, 200}};
+    for (auto& size : sizes) {
+        int n = size[0], m = size[1];
+        auto matrices = make_shared<Matrices>(make_levels(n, m));
+        cases.push_back({"detect/detect_deadlock_" + to_string(n) + "x" + to_string(m), [matrices](long iters) {
+            for (long i = 0; i < iters; i++) {
+                sink = detect_deadlock(matrices->allocation, matrices->request, matrices->available);
+            }
+        }});
+    }
+
+    cases.push_back({"parser/parseTrains_20000", [](long n) {
+        static string path = write_trains_file(20000, 5);
+        for (long i = 0; i < n; i++) sink = parseTrains(path).size();
+    }});
+    return cases;
+}
+
+// ---------------------------------------------------------------- measurement
+
+// acquire/release print every step with std::endl, as they do in the simulator. Pointing stdout at
+// /dev/null keeps that formatting and the write per line in the measurement, only off the terminal.
+static int stdout_to_null() {
+    cout.flush();
+    int saved = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+    return saved;
+}
+
+static void restore_stdout(int saved) {
+    cout.flush();
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+// Grows the iteration count until one sample takes at least min_sample_ms
+static long calibrate(const BenchCase& c, long min_sample_ms) {
+    long iterations = 1;
+    while (true) {
+        long start = now_ns();
+        c.run(iterations);
+        long elapsed = now_ns() - start;
+        if (elapsed >= min_sample_ms * 1000000L || iterations >= (1L << 30)) return iterations;
+        long target = elapsed > 0 ? (long)(iterations * 1.2 * min_sample_ms * 1000000L / elapsed) : iterations * 100;
+        iterations = max(iterations * 2, min(target, iterations * 100));
+    }
+}
+
+static CaseResult measure(const BenchCase& c, int samples, long min_sample_ms) {
+    CaseResult r;
+    r.name = c.name;
+    r.iterations = calibrate(c, min_sample_ms);
+    for (int s = 0; s < WARMUP_SAMPLES + samples; s++) {
+        long start = now_ns();
+        c.run(r.iterations);
+        double ns = (double)(now_ns() - start) / r.iterations;
+        if (s >= WARMUP_SAMPLES) r.ns_per_op.push_back(ns);
+    }
+    vector<double> sorted = r.ns_per_op;
+    sort(sorted.begin(), sorted.end());
+    size_t mid = sorted.size() / 2;
+    r.median = sorted.size() % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2;
+    r.min = sorted.front();
+    r.mean = accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+    double var = 0;
+    for (double x : sorted) var += (x - r.mean) * (x - r.mean);
+    r.stddev = sorted.size() > 1 ? sqrt(var / (sorted.size() - 1)) : 0;
+    return r;
+}
+
+// One case per line, so the baseline can be read back without a JSON library
+static bool write_json(const string& path, const vector<CaseResult>& results, int samples) {
+    ofstream out(path);
+    if (!out) return false;
+    char host[256] = "";
+    gethostname(host, sizeof(host) - 1);
+    out << "{\n  \"host\": \"" << host << "\",\n  \"time\": " << time(nullptr) << ",\n  \"samples\": " << samples
+        << ",\n  \"cases\": [\n";
+    out << fixed << setprecision(2);
+    for (size_t i = 0; i < results.size(); i++) {
+        const CaseResult& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"ns_per_op\": " << r.median << ", \"min\": " << r.min
+            << ", \"mean\": " << r.mean << ", \"stddev\": " << r.stddev << ", \"iterations\": " << r.iterations << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return (bool)out;
+}
+
+// name -> median ns/op of a file written by write_json
+static bool read_baseline(const string& path, map<string, double>& baseline) {
+    ifstream in(path);
+    if (!in) return false;
+    string line;
+    while (getline(in, line)) {
+        size_t name_at = line.find("\"name\": \"");
+        size_t ns_at = line.find("\"ns_per_op\": ");
+        if (name_at == string::npos || ns_at == string::npos) continue;
+        name_at += 9;
+        string name = line.substr(name_at, line.find('"', name_at) - name_at);
+        baseline[name] = atof(line.c_str() + ns_at + 13);
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    string filter, json_path, baseline_path;
+    int samples = 10;
+    long min_sample_ms = 20;
+    double threshold_pct = 10;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg.rfind("--filter=", 0) == 0) {
+            filter = arg.substr(9);
+        } else if (arg.rfind("--samples=", 0) == 0) {
+            samples = max(1, atoi(arg.c_str() + 10));
+        } else if (arg.rfind("--min-sample-ms=", 0) == 0) {
+            min_sample_ms = max(1L, atol(arg.c_str() + 16));
+        } else if (arg.rfind("--json=", 0) == 0) {
+            json_path = arg.substr(7);
+        } else if (arg.rfind("--baseline=", 0) == 0) {
+            baseline_path = arg.substr(11);
+        } else if (arg.rfind("--threshold=", 0) == 0) {
+            threshold_pct = atof(arg.c_str() + 12);
+        } else {
+            cerr << "Usage: " << argv[0] << " [--filter=SUBSTR] [--samples=N] [--min-sample-ms=MS] [--json=PATH]"
+                 << " [--baseline=PATH] [--threshold=PCT]\n";
+            return 1;
+        }
+    }
+
+    map<string, double> baseline;
+    if (!baseline_path.empty() && !read_baseline(baseline_path, baseline)) {
+        cerr << "Error: Could not read baseline " << baseline_path << endl;
+        return 1;
+    }
+
+    char dir_template[] = "/tmp/bench_micro.XXXXXX";
+    if (!mkdtemp(dir_template)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    scratch_dir = dir_template;
+
+    cout << left << setw(40) << "case" << right << setw(14) << "ns/op" << setw(12) << "min" << setw(10) << "stddev"
+         << setw(12) << "iters" << (baseline.empty() ? "" : "    vs baseline") << "\n";
+    vector<CaseResult> results;
+    int regressions = 0;
+    for (const BenchCase& c : make_cases()) {
+        if (!filter.empty() && c.name.find(filter) == string::npos) continue;
+        int saved_stdout = stdout_to_null();
+        CaseResult r = measure(c, samples, min_sample_ms);
+        restore_stdout(saved_stdout);
+        results.push_back(r);
+
+        cout << left << setw(40) << r.name << right << fixed << setprecision(1) << setw(14) << r.median << setw(12) << r.min
+             << setw(9) << (r.mean > 0 ? 100 * r.stddev / r.mean : 0) << "%" << setw(12) << r.iterations;
+        auto it = baseline.find(r.name);
+        if (it != baseline.end() && it->second > 0) {
+            double change = 100 * (r.median / it->second - 1);
+            // Only when even the fastest sample is past the threshold, so one noisy sample cannot fail the run
+            bool regressed = change > threshold_pct && 100 * (r.min / it->second - 1) > threshold_pct;
+            regressions += regressed;
+            cout << "    " << showpos << change << "%" << noshowpos << (regressed ? "  REGRESSED" : "");
+        }
+        cout << "\n";
+    }
+
+    // Nothing written outside scratch_dir, including the segments of log_segments
+    string cleanup = "rm -rf '" + scratch_dir + "'";
+    if (system(cleanup.c_str()) != 0) cerr << "Warning: Could not remove " << scratch_dir << endl;
+
+    if (!json_path.empty()) {
+        if (!write_json(json_path, results, samples)) {
+            cerr << "Error: Could not write " << json_path << endl;
+            return 1;
+        }
+        cout << "Results written to " << json_path << "\n";
+    }
+    if (regressions > 0) {
+        cout << regressions << " case(s) slower than the baseline by more than " << threshold_pct << "%\n";
+        return 2;
+    }
+    return 0;
+}
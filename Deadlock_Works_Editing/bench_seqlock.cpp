@@ -0,0 +1,174 @@
+// Group : I
+// Author: Samuel Shankle
+// Email: samuel.shankle@okstate.edu
+// Date: 10/19/2026
+// Description: Observer-interference benchmark for the intersection table. One server process grants and releases
+// intersections through sync.cpp while observer processes read the whole table at a fixed period, once by taking
+// shared_memory_mutex and copying (how a monitor had to do it before) and once with snapshot_intersections().
+// With the mutex the server's throughput falls as observers read more often; with the seqlock it should not.
+// The server loop never sleeps, so each of its voluntary context switches is a wait for a lock an observer held:
+// that count isolates the interference even on one CPU, where observers also take CPU time in either mode.
+// Usage: ./bench_seqlock [observers] [ms_per_case]
+
+#include "sync.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <ctime>
+#include <new>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+using namespace std;
+
+#define BENCH_INTERSECTIONS 16
+
+// Written by the children, read by the parent once they have exited
+struct Results {
+    long server_ops;
+    long server_blocks;   // voluntary context switches of the server
+    long observer_reads;
+    long observer_retries;
+};
+
+static long now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void init_table(SharedMemory* shm) {
+    new (shm) SharedMemory(); // the same process-shared mutexes main creates
+    for (int i = 0; i < BENCH_INTERSECTIONS; ++i) {
+        snprintf(shm->intersections[i].name, MAX_INTERSECTION_NAME_LENGTH, "Intersection%d", i + 1);
+        int capacity = i % 2 == 0 ? 1 : 3;
+        shm->intersections[i].capacity = capacity;
+        shm->intersections[i].lock_type = capacity == 1 ? 1 : capacity;
+        ticket_init(&shm->semaphores[i], capacity);
+    }
+}
+
+// The server's hot path: every intersection granted to a train and released again
+static void run_server(SharedMemory* shm, Results* results, long deadline_ns) {
+    cout.setstate(ios::failbit); // sync.cpp reports every grant on stdout
+    cerr.setstate(ios::failbit);
+    vector<string> names;
+    for (int i = 0; i < BENCH_INTERSECTIONS; ++i) names.push_back(shm->intersections[i].name);
+    long ops = 0;
+    while (now_ns() < deadline_ns) {
+        for (int i = 0; i < BENCH_INTERSECTIONS; ++i) {
+            if (try_acquire_intersection(1, i, shm)) handle_release_request(1, names[i], shm);
+            ops++;
+        }
+    }
+    results->server_ops = ops;
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    results->server_blocks = usage.ru_nvcsw;
+}
+
+// Copies the same fields snapshot_intersections() does, but under the server's lock
+static void locked_copy(SharedMemory* shm, TableSnapshot& out) {
+    pthread_mutex_lock(&shm->shared_memory_mutex);
+    for (int i = 0; i < MAX_INTERSECTIONS; ++i) {
+        IntersectionSnapshot& copy = out.intersections[i];
+        memcpy(copy.name, shm->intersections[i].name, sizeof(copy.name));
+        copy.capacity = shm->intersections[i].capacity;
+        copy.lock_type = shm->intersections[i].lock_type;
+        copy.num_holding_trains = shm->locks[i].num_holding_trains;
+        memcpy(copy.holding_trains, shm->locks[i].holding_trains, sizeof(copy.holding_trains));
+    }
+    pthread_mutex_unlock(&shm->shared_memory_mutex);
+}
+
+static void run_observer(SharedMemory* shm, bool seqlock, long period_us, Results* results, long deadline_ns) {
+    TableSnapshot snapshot;
+    long reads = 0, retries = 0;
+    while (now_ns() < deadline_ns) {
+        if (seqlock) {
+            retries += snapshot_intersections(shm, snapshot);
+        } else {
+            locked_copy(shm, snapshot);
+        }
+        reads++;
+        if (period_us > 0) usleep(period_us);
+    }
+    results->observer_reads = reads;
+    results->observer_retries = retries;
+}
+
+// Returns server operations per second; observer totals are left in results[1..]
+static double run_case(SharedMemory* shm, Results* results, int observers, bool seqlock, long period_us, long ms) {
+    init_table(shm);
+    for (int p = 0; p <= observers; ++p) results[p] = Results();
+    long start = now_ns();
+    long deadline = start + ms * 1000000L;
+
+    vector<pid_t> children;
+    for (int p = 0; p <= observers; ++p) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            if (p == 0) {
+                run_server(shm, &results[0], deadline);
+            } else {
+                run_observer(shm, seqlock, period_us, &results[p], deadline);
+            }
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) waitpid(pid, nullptr, 0);
+    double seconds = (now_ns() - start) / 1e9;
+    return results[0].server_ops / seconds;
+}
+
+int main(int argc, char* argv[]) {
+    int observers = argc > 1 ? stoi(argv[1]) : 2;
+    long ms = argc > 2 ? stol(argv[2]) : 1000;
+    if (observers < 1) observers = 1;
+
+    size_t size = sizeof(SharedMemory) + sizeof(Results) * (observers + 1);
+    void* arena = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (arena == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    SharedMemory* shm = (SharedMemory*)arena;
+    Results* results = (Results*)((char*)arena + sizeof(SharedMemory));
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cout << "=== Observer interference: 1 server, " << observers << " observers, " << ms << " ms per case, "
+         << cpus << " CPUs ===" << endl;
+    double baseline = run_case(shm, results, 0, true, 0, ms);
+    cout << fixed << setprecision(2) << "no observers: " << baseline / 1e6 << " M server ops/s" << endl << endl;
+
+    cout << left << setw(12) << "period" << right << setw(16) << "mutex ops/s" << setw(9) << "vs none"
+         << setw(10) << "blocks" << setw(16) << "seqlock ops/s" << setw(9) << "vs none" << setw(10) << "blocks"
+         << setw(12) << "reads/s" << setw(14) << "retries/read" << endl;
+    long periods[] = {10000, 1000, 100, 10, 0};
+    for (long period : periods) {
+        double locked = run_case(shm, results, observers, false, period, ms);
+        long locked_blocks = results[0].server_blocks;
+        double seq = run_case(shm, results, observers, true, period, ms);
+        long seq_blocks = results[0].server_blocks;
+        long reads = 0, retries = 0;
+        for (int p = 1; p <= observers; ++p) {
+            reads += results[p].observer_reads;
+            retries += results[p].observer_retries;
+        }
+        string label = period > 0 ? to_string(period) + " us" : "continuous";
+        cout << left << setw(12) << label << right << setprecision(2) << setw(14) << locked / 1e6 << " M"
+             << setw(8) << locked / baseline * 100 << "%" << setw(10) << locked_blocks << setw(14) << seq / 1e6
+             << " M" << setw(8) << seq / baseline * 100 << "%" << setw(10) << seq_blocks << setw(12)
+             << (long)(reads * 1000.0 / ms) << setw(14) << (reads ? (double)retries / reads : 0) << endl;
+    }
+    if (cpus < 2) {
+        cout << "Note: one CPU, so a continuous observer takes CPU time from the server in either mode" << endl;
+    }
+
+    munmap(arena, size);
+    return 0;
+}
@@ -0,0 +1,209 @@
+// Group : I
+// Author: Brandon Collings
+// Email: brandon.l.collings@okstate.edu
+// Date: 10/19/2026
+// Description: Benchmark for running in-process trains on a fixed number of threads when route lengths are
+// skewed: static train-to-thread assignment, one shared task queue, and the work-stealing executor. Every train
+// step does some train work, then shard work under the lock of the shard that owns the intersection, then
+// schedules the next step. Utilization is the CPU time spent in steps over threads x makespan.
+// Usage: ./bench_steal [trains] [threads] [shards]
+
+#include "work_stealing.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <ctime>
+
+using namespace std;
+
+#define STEP_WORK_US 20
+#define SHARD_WORK_US 5
+
+static long spins_per_us = 1;
+
+static void spin(long us) {
+    volatile unsigned long sink = 0;
+    for (long i = 0; i < us * spins_per_us; i++) sink = sink + i;
+}
+
+static long thread_cpu_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void calibrate() {
+    long start = thread_cpu_ns();
+    spins_per_us = 1000000;
+    spin(1);
+    long ns = thread_cpu_ns() - start;
+    spins_per_us = ns > 0 ? 1000000L * 1000 / ns : 1000;
+}
+
+struct Workload {
+    vector<vector<int>> routes;      // shard of every hop
+    vector<unique_ptr<mutex>> shard_locks;
+    atomic<long> busy_ns{0};
+    atomic<long> steps{0};
+};
+
+// Most routes are a few hops and a few are hundreds, like a mix of local and long-haul trains
+static void make_workload(Workload& w, int trains, int shards) {
+    mt19937 rng(7);
+    uniform_real_distribution<double> u(0.01, 1.0);
+    w.routes.resize(trains);
+    for (int t = 0; t < trains; t++) {
+        int hops = min(400, (int)(2 / (u(rng) * u(rng))));
+        for (int h = 0; h < hops; h++) w.routes[t].push_back(rng() % shards);
+    }
+    for (int s = 0; s < shards; s++) w.shard_locks.emplace_back(new mutex());
+}
+
+static void run_step(Workload& w, int train, int hop) {
+    long start = thread_cpu_ns();
+    spin(STEP_WORK_US);
+    {
+        lock_guard<mutex> lock(*w.shard_locks[w.routes[train][hop]]);
+        spin(SHARD_WORK_US);
+    }
+    w.busy_ns += thread_cpu_ns() - start;
+    w.steps++;
+}
+
+// One deque and one lock for every thread
+class SharedQueuePool {
+public:
+    explicit SharedQueuePool(int num_threads) {
+        for (int t = 0; t < num_threads; t++) threads.emplace_back(&SharedQueuePool::worker_loop, this);
+    }
+    ~SharedQueuePool() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (thread& t : threads) t.join();
+    }
+    void submit(function<void()> task) {
+        {
+            lock_guard<mutex> lock(mtx);
+            tasks.push_back(move(task));
+            outstanding++;
+        }
+        cv.notify_one();
+    }
+    void wait_idle() {
+        unique_lock<mutex> lock(mtx);
+        idle_cv.wait(lock, [&] { return outstanding == 0; });
+    }
+
+private:
+    vector<thread> threads;
+    deque<function<void()>> tasks;
+    mutex mtx;
+    condition_variable cv, idle_cv;
+    long outstanding = 0;
+    bool stopping = false;
+
+    void worker_loop() {
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            cv.wait(lock, [&] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            function<void()> task = move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+            if (--outstanding == 0) idle_cv.notify_all();
+        }
+    }
+};
+
+// A train's next step is a new task, so a long route can move between threads
+template <class Pool>
+static void schedule_train(Pool& pool, Workload& w, int train, int hop) {
+    pool.submit([&pool, &w, train, hop] {
+        run_step(w, train, hop);
+        if (hop + 1 < (int)w.routes[train].size()) schedule_train(pool, w, train, hop + 1);
+    });
+}
+
+struct Result {
+    double ms;
+    double utilization;
+};
+
+static Result measure(Workload& w, int threads, const function<void()>& run) {
+    w.busy_ns = 0;
+    w.steps = 0;
+    auto start = chrono::steady_clock::now();
+    run();
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return {ms, w.busy_ns / 1e6 / (ms * threads)};
+}
+
+int main(int argc, char* argv[]) {
+    int trains = argc > 1 ? stoi(argv[1]) : 2000;
+    int threads = argc > 2 ? stoi(argv[2]) : (int)thread::hardware_concurrency();
+    int shards = argc > 3 ? stoi(argv[3]) : 16;
+    if (threads < 1) threads = 1;
+    calibrate();
+
+    Workload w;
+    make_workload(w, trains, shards);
+    long total_steps = 0;
+    size_t longest = 0;
+    for (const vector<int>& r : w.routes) {
+        total_steps += r.size();
+        longest = max(longest, r.size());
+    }
+    cout << "Skewed routes: " << trains << " trains, " << total_steps << " steps (longest " << longest << "), "
+         << threads << " threads, " << shards << " shards, " << STEP_WORK_US << "+" << SHARD_WORK_US << " us per step\n\n";
+
+    Result fixed_result = measure(w, threads, [&] {
+        vector<thread> pool;
+        for (int t = 0; t < threads; t++) {
+            pool.emplace_back([&, t] {
+                for (int train = t; train < trains; train += threads) {
+                    for (size_t hop = 0; hop < w.routes[train].size(); hop++) run_step(w, train, hop);
+                }
+            });
+        }
+        for (thread& t : pool) t.join();
+    });
+
+    Result shared_result = measure(w, threads, [&] {
+        SharedQueuePool pool(threads);
+        for (int train = 0; train < trains; train++) schedule_train(pool, w, train, 0);
+        pool.wait_idle();
+    });
+
+    WorkStealingPool::Counters counters;
+    Result steal_result = measure(w, threads, [&] {
+        WorkStealingPool pool(threads);
+        for (int train = 0; train < trains; train++) schedule_train(pool, w, train, 0);
+        pool.wait_idle();
+        counters = pool.total();
+    });
+
+    auto row = [&](const string& name, const Result& r) {
+        cout << "  " << left << setw(20) << name << right << fixed << setprecision(1) << setw(10) << r.ms << " ms   utilization "
+             << setw(5) << r.utilization * 100 << "%\n";
+    };
+    row("static assignment", fixed_result);
+    row("shared queue", shared_result);
+    row("work stealing", steal_result);
+    cout << "\n  work stealing: " << counters.tasks << " tasks, " << counters.steals << " steals, " << counters.failed_steals
+         << " failed steal rounds, " << setprecision(1) << counters.idle_ns / 1e6 << " ms idle over all workers\n";
+    return 0;
+}
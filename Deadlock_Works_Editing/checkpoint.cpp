@@ -0,0 +1,175 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Serializes simulation checkpoints to and from a memory mapped file.
+
+#include "checkpoint.h"
+#include "sync.h"
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct CheckpointHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t payload_bytes;
+    uint64_t checksum;       // FNV-1a of the payload, catches torn or truncated files
+    int64_t sequence;
+    int32_t sim_time;
+    int32_t num_intersections;
+    int32_t num_trains;
+    int32_t reserved;
+};
+
+static uint64_t checksum(const char* data, size_t size) {
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static void put(std::string& out, int64_t value) {
+    out.append((const char*)&value, sizeof(value));
+}
+
+static bool get(const char*& in, const char* end, int64_t& value) {
+    if (end - in < (long)sizeof(value)) return false;
+    memcpy(&value, in, sizeof(value));
+    in += sizeof(value);
+    return true;
+}
+
+bool save_checkpoint(const std::string& path, const Checkpoint& checkpoint) {
+    std::string payload;
+    for (size_t r = 0; r < checkpoint.intersections.size(); ++r) {
+        char name[MAX_INTERSECTION_NAME_LENGTH] = {};
+        strncpy(name, checkpoint.intersections[r].c_str(), sizeof(name) - 1);
+        payload.append(name, sizeof(name));
+        put(payload, checkpoint.queues[r].size());
+        for (int t : checkpoint.queues[r]) put(payload, t);
+    }
+    for (const TrainCheckpoint& train : checkpoint.trains) {
+        put(payload, train.route_pos);
+        put(payload, train.done);
+        put(payload, train.waiting_on);
+        put(payload, train.waited_ms);
+        put(payload, train.held.size());
+        for (int r : train.held) put(payload, r);
+    }
+
+    CheckpointHeader header = {};
+    header.magic = CHECKPOINT_MAGIC;
+    header.version = CHECKPOINT_VERSION;
+    header.payload_bytes = payload.size();
+    header.checksum = checksum(payload.data(), payload.size());
+    header.sequence = checkpoint.sequence;
+    header.sim_time = checkpoint.sim_time;
+    header.num_intersections = checkpoint.intersections.size();
+    header.num_trains = checkpoint.trains.size();
+
+    std::string tmp_path = path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("open checkpoint");
+        return false;
+    }
+    size_t size = sizeof(header) + payload.size();
+    if (ftruncate(fd, size) < 0) {
+        perror("ftruncate checkpoint");
+        close(fd);
+        return false;
+    }
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        perror("mmap checkpoint");
+        return false;
+    }
+
+    memcpy(addr, &header, sizeof(header));
+    memcpy((char*)addr + sizeof(header), payload.data(), payload.size());
+    bool synced = msync(addr, size, MS_SYNC) == 0;
+    munmap(addr, size);
+
+    // Readers only ever see the previous complete checkpoint or this one
+    return synced && rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+bool load_checkpoint(const std::string& path, Checkpoint& checkpoint) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(CheckpointHeader)) {
+        close(fd);
+        return false;
+    }
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return false;
+
+    const char* base = (const char*)addr;
+    CheckpointHeader header;
+    memcpy(&header, base, sizeof(header));
+    const char* in = base + sizeof(header);
+    const char* end = base + st.st_size;
+
+    bool ok = header.magic == CHECKPOINT_MAGIC && header.version == CHECKPOINT_VERSION &&
+              header.payload_bytes == (uint64_t)(end - in) &&
+              header.checksum == checksum(in, header.payload_bytes) &&
+              header.num_intersections >= 0 && header.num_intersections <= MAX_INTERSECTIONS &&
+              header.num_trains >= 0;
+
+    checkpoint = Checkpoint();
+    checkpoint.sequence = header.sequence;
+    checkpoint.sim_time = header.sim_time;
+    int64_t count, value;
+    for (int r = 0; ok && r < header.num_intersections; ++r) {
+        if (end - in < MAX_INTERSECTION_NAME_LENGTH) {
+            ok = false;
+            break;
+        }
+        checkpoint.intersections.push_back(std::string(in, strnlen(in, MAX_INTERSECTION_NAME_LENGTH)));
+        in += MAX_INTERSECTION_NAME_LENGTH;
+        checkpoint.queues.emplace_back();
+        ok = get(in, end, count);
+        for (int64_t i = 0; ok && i < count; ++i) {
+            ok = get(in, end, value) && value >= 0 && value < header.num_trains;
+            if (ok) checkpoint.queues[r].push_back(value);
+        }
+    }
+    for (int t = 0; ok && t < header.num_trains; ++t) {
+        TrainCheckpoint train;
+        int64_t done;
+        ok = get(in, end, value) && get(in, end, done);
+        if (!ok) break;
+        train.route_pos = value;
+        train.done = done != 0;
+        ok = get(in, end, value) && value >= -1 && value < header.num_intersections;
+        if (!ok) break;
+        train.waiting_on = value;
+        ok = get(in, end, value) && get(in, end, count);
+        if (!ok) break;
+        train.waited_ms = value;
+        for (int64_t i = 0; ok && i < count; ++i) {
+            ok = get(in, end, value) && value >= 0 && value < header.num_intersections;
+            if (ok) train.held.push_back(value);
+        }
+        checkpoint.trains.push_back(train);
+    }
+
+    munmap(addr, st.st_size);
+    return ok && in == end;
+}
+
+bool checkpoint_matches(const Checkpoint& checkpoint, SharedMemory* shm, int num_intersections, int num_trains) {
+    if ((int)checkpoint.intersections.size() != num_intersections || (int)checkpoint.trains.size() != num_trains) {
+        return false;
+    }
+    for (int r = 0; r < num_intersections; ++r) {
+        if (checkpoint.intersections[r] != shm->intersections[r].name) return false;
+    }
+    return true;
+}
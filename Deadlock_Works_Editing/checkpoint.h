@@ -0,0 +1,43 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Declares the simulation checkpoint: holdings, wait queues and each train's route position,
+// stored in a memory mapped file so a run that dies can resume where it left off.
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <vector>
+
+struct SharedMemory;
+
+#define CHECKPOINT_MAGIC 0x54434b50u // "PKCT"
+#define CHECKPOINT_VERSION 1
+
+struct TrainCheckpoint {
+    int route_pos = 0;      // acquires answered in the current attempt, i.e. the next hop to request
+    bool done = false;      // started releasing, nothing left to resume
+    int waiting_on = -1;    // intersection the pending acquire is queued on, or -1
+    long waited_ms = 0;     // how long it had been queued when the snapshot was taken
+    std::vector<int> held;  // intersections held
+};
+
+struct Checkpoint {
+    long sequence = 0;
+    int sim_time = 0;
+    std::vector<std::string> intersections;  // names, in shared memory order
+    std::vector<std::vector<int>> queues;    // waiting train indices per intersection, oldest first
+    std::vector<TrainCheckpoint> trains;
+};
+
+// Writes path atomically (temporary file, msync, rename). Returns false on any I/O error.
+bool save_checkpoint(const std::string& path, const Checkpoint& checkpoint);
+
+// Reads and verifies a checkpoint. Returns false if it is missing, truncated or corrupt.
+bool load_checkpoint(const std::string& path, Checkpoint& checkpoint);
+
+// Checks that a checkpoint was taken with the same intersections and train count as this run
+bool checkpoint_matches(const Checkpoint& checkpoint, SharedMemory* shm, int num_intersections, int num_trains);
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,81 @@
+// Group : I
+// Author: Brandon Collings
+// Email: brandon.l.collings@okstate.edu
+// Date: 10/19/2026
+// Description: Implements union-find (path halving, union by size) over the train/intersection resource graph.
+
+#include "components.h"
+#include <utility>
+
+ResourceComponents::ResourceComponents(int num_trains, int num_intersections)
+    : num_trains(num_trains), num_intersections(num_intersections)
+{
+    rebuild({}, {});
+}
+
+void ResourceComponents::rebuild(const std::vector<std::vector<int>>& allocation,
+                                 const std::vector<std::vector<int>>& request) {
+    int nodes = num_trains + num_intersections;
+    parent.resize(nodes);
+    size.assign(nodes, 1);
+    trains.assign(nodes, std::vector<int>());
+    intersections.assign(nodes, std::vector<int>());
+    for (int node = 0; node < nodes; ++node) {
+        parent[node] = node;
+    }
+    for (int t = 0; t < num_trains; ++t) {
+        trains[t].push_back(t);
+    }
+    for (int r = 0; r < num_intersections; ++r) {
+        intersections[num_trains + r].push_back(r);
+    }
+    largest_trains = num_trains > 0 ? 1 : 0;
+
+    for (int t = 0; t < (int)allocation.size() && t < num_trains; ++t) {
+        for (int r = 0; r < (int)allocation[t].size() && r < num_intersections; ++r) {
+            if (allocation[t][r] || request[t][r]) link(t, r);
+        }
+    }
+}
+
+int ResourceComponents::find(int node) {
+    while (parent[node] != node) {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+    return node;
+}
+
+void ResourceComponents::link(int train_idx, int inter_idx) {
+    int a = find(train_idx);
+    int b = find(num_trains + inter_idx);
+    if (a == b) return;
+
+    // Smaller component joins the larger one so each member list is copied O(log n) times
+    if (size[a] < size[b]) std::swap(a, b);
+    parent[b] = a;
+    size[a] += size[b];
+
+    trains[a].insert(trains[a].end(), trains[b].begin(), trains[b].end());
+    if ((int)trains[a].size() > largest_trains) largest_trains = trains[a].size();
+    intersections[a].insert(intersections[a].end(), intersections[b].begin(), intersections[b].end());
+    std::vector<int>().swap(trains[b]);
+    std::vector<int>().swap(intersections[b]);
+}
+
+int ResourceComponents::add_intersection() {
+    int node = parent.size(); // == num_trains + num_intersections
+    parent.push_back(node);
+    size.push_back(1);
+    trains.emplace_back();
+    intersections.emplace_back(1, num_intersections);
+    return num_intersections++;
+}
+
+const std::vector<int>& ResourceComponents::trains_with(int train_idx) {
+    return trains[find(train_idx)];
+}
+
+const std::vector<int>& ResourceComponents::intersections_with(int train_idx) {
+    return intersections[find(train_idx)];
+}
@@ -0,0 +1,46 @@
+// Group : I
+// Author: Brandon Collings
+// Email: brandon.l.collings@okstate.edu
+// Date: 10/19/2026
+// Description: Declares a union-find over trains and intersections so deadlock detection can be limited to the connected part of the resource graph a request touches.
+
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <vector>
+
+// Connected components of the resource graph. Node ids 0..num_trains-1 are trains and
+// num_trains..num_trains+num_intersections-1 are intersections. A train and an
+// intersection are linked once the train has requested it, so a wait-for cycle can only
+// ever involve trains and intersections from the same component. Links are never undone,
+// so over a long run components grow toward the union of every route seen; rebuild() shrinks
+// them back to what the live allocation and request edges connect.
+struct ResourceComponents {
+    int num_trains;
+    int num_intersections;
+    int largest_trains = 1; // trains in the largest component since the last rebuild
+    std::vector<int> parent;
+    std::vector<int> size;
+    std::vector<std::vector<int>> trains;        // Train indices owned by each root
+    std::vector<std::vector<int>> intersections; // Intersection indices owned by each root
+
+    ResourceComponents(int num_trains, int num_intersections);
+
+    // Returns the root node of the component containing node
+    int find(int node);
+
+    // Records that train_idx has requested inter_idx, merging their components
+    void link(int train_idx, int inter_idx);
+
+    // Resets to singletons, then links every train to the intersections it holds or requests
+    void rebuild(const std::vector<std::vector<int>>& allocation, const std::vector<std::vector<int>>& request);
+
+    // Adds an intersection in a component of its own (hot reload) and returns its index
+    int add_intersection();
+
+    // Returns the trains and intersections in the same component as train_idx
+    const std::vector<int>& trains_with(int train_idx);
+    const std::vector<int>& intersections_with(int train_idx);
+};
+
+#endif // COMPONENTS_H
@@ -0,0 +1,641 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Runs the simulation with every train as a C++20 coroutine instead of a process or thread. A train
+// co_awaits acquire and traverse and is parked in the intersection's wait queue while it waits, so it costs its
+// coroutine frame and its route, not a stack and a kernel thread. The server logic (FIFO grants, deadlock
+// detection, victim recovery) runs in-process on the event loops. With --loops=N every loop owns the
+// intersections shard_of() gives it, like the sharded server, and a train moves to the loop of the intersection
+// it is acquiring.
+// Usage: ./coro_sim [intersections.txt] [trains.txt] [--loops=N] [--traverse-ms=MS] [--movement=hold|hop]
+//                   [--clock=virtual|real] [--detect-ms=MS] [--synthetic=TRAINS,INTERSECTIONS,HOPS] [--seed=N]
+// Build: g++ -std=c++20 -O2 -pthread coro_sim.cpp parser.cpp transport.cpp -o coro_sim
+//
+// The virtual clock (the default with one loop) jumps straight to the next traversal that ends, so a run takes
+// as long as its events, not as long as its simulated time. Several loops need the real clock.
+
+#include "parser.h"
+#include "transport.h"
+#include <coroutine>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#define DEFAULT_TRAVERSE_MS 1000
+#define DEFAULT_DETECT_MS 250
+#define CROSS_LOOP_TIMEOUT_MS 2000
+
+enum MovementMode { MOVE_HOLD_ALL, MOVE_HOP };
+
+struct TrainState {
+    int id;                         // 1-based, as in the logs of ./main
+    std::vector<int> route;         // intersection indices
+    std::vector<int> held;
+    int waiting_on = -1;            // set by the loop it is queued on
+    long wait_start = 0;
+    bool denied = false;            // aborted as a deadlock victim while waiting
+    int restarts = 0;
+    std::coroutine_handle<> handle; // where to resume it once granted
+};
+
+struct IntersectionState {
+    std::string name;
+    int capacity;
+    int owner;                      // loop that grants it
+    std::vector<TrainState*> holders;
+    std::deque<TrainState*> waiting;
+};
+
+// Work handed to another loop: the intersection belongs to it
+struct LoopEvent {
+    enum Kind { ACQUIRE, RELEASE } kind;
+    TrainState* train;
+    int inter;
+};
+
+struct Timer {
+    long due;
+    long seq;                       // FIFO among timers due together
+    std::coroutine_handle<> handle;
+    bool operator>(const Timer& other) const { return due != other.due ? due > other.due : seq > other.seq; }
+};
+
+class EventLoop;
+
+struct Simulation {
+    std::vector<IntersectionState> intersections;
+    std::vector<TrainState> trains;
+    std::vector<std::unique_ptr<EventLoop>> loops;
+    MovementMode movement = MOVE_HOLD_ALL;
+    bool virtual_clock = true;
+    long traverse_ms = DEFAULT_TRAVERSE_MS;
+    long detect_ms = DEFAULT_DETECT_MS;
+    std::chrono::steady_clock::time_point start;
+    std::atomic<long> finished{0};
+};
+
+static Simulation sim;
+static thread_local EventLoop* current_loop = nullptr;
+
+// Size of a train's coroutine frame, to report what a train costs
+static std::atomic<long> frame_bytes{0};
+
+static void finish_train();
+
+// ---------------------------------------------------------------- coroutine plumbing
+
+// A train's coroutine. It starts suspended, is resumed by whichever loop it is on, and frees its own
+// frame when the route is done.
+struct TrainTask {
+    struct promise_type {
+        TrainTask get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() { finish_train(); }
+        void unhandled_exception() { std::terminate(); }
+
+        static void* operator new(size_t size) {
+            frame_bytes = size;
+            return ::operator new(size);
+        }
+    };
+    std::coroutine_handle<promise_type> handle;
+};
+
+class EventLoop {
+public:
+    explicit EventLoop(int index) : index(index) {}
+
+    int index;
+    long now = 0;
+    long grants = 0, aborts = 0, detections = 0;
+
+    void schedule(std::coroutine_handle<> h) { ready.push_back(h); }
+
+    void sleep_until(long due, std::coroutine_handle<> h) { timers.push({due, timer_seq++, h}); }
+
+    void post(const LoopEvent& event) {
+        {
+            std::lock_guard<std::mutex> lock(inbox_mutex);
+            inbox.push_back(event);
+        }
+        inbox_cv.notify_one();
+    }
+
+    void wake() {
+        { std::lock_guard<std::mutex> lock(inbox_mutex); }
+        inbox_cv.notify_one();
+    }
+
+    // Grants the intersection now or queues the train behind the ones already waiting.
+    // Only called on the owning loop. Returns true if granted.
+    bool acquire(TrainState& train, int inter) {
+        IntersectionState& x = sim.intersections[inter];
+        if (x.waiting.empty() && (int)x.holders.size() < x.capacity) {
+            grant(train, inter);
+            return true;
+        }
+        train.waiting_on = inter;
+        train.wait_start = now;
+        x.waiting.push_back(&train);
+        return false;
+    }
+
+    void release(TrainState& train, int inter) {
+        IntersectionState& x = sim.intersections[inter];
+        auto it = std::find(x.holders.begin(), x.holders.end(), &train);
+        if (it == x.holders.end()) return;
+        *it = x.holders.back();
+        x.holders.pop_back();
+        while (!x.waiting.empty() && (int)x.holders.size() < x.capacity) {
+            TrainState* next = x.waiting.front();
+            x.waiting.pop_front();
+            next->waiting_on = -1;
+            grant(*next, inter);
+            schedule(next->handle);
+        }
+    }
+
+    void run();
+
+private:
+    std::deque<std::coroutine_handle<>> ready;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+    long timer_seq = 0;
+    long next_detect = 0;
+
+    std::mutex inbox_mutex;
+    std::condition_variable inbox_cv;
+    std::vector<LoopEvent> inbox;
+
+    // Detection scratch, sized on first use
+    std::vector<uint32_t> mark;   // train index -> epoch it is blocked in, 0 once finished
+    std::vector<int> work;        // intersection index -> free slots in the reduction
+    std::vector<bool> scanned;
+    uint32_t epoch = 0;
+
+    void grant(TrainState& train, int inter) {
+        sim.intersections[inter].holders.push_back(&train);
+        train.held.push_back(inter);
+        grants++;
+    }
+
+    long clock_ms() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - sim.start).count();
+    }
+
+    bool drain_inbox();
+    void detect();
+    void abort_train(TrainState& victim);
+    void expire_cross_loop_waits();
+};
+
+// Suspends the train until the intersection is granted. co_await yields false if the train was
+// chosen as a deadlock victim instead, with everything it held already released.
+struct Acquire {
+    TrainState& train;
+    int inter;
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        train.handle = h;
+        int owner = sim.intersections[inter].owner;
+        if (owner != current_loop->index) {
+            // The owner may resume the train before post() even returns, so nothing here touches the
+            // frame (this awaiter included) afterwards
+            sim.loops[owner]->post({LoopEvent::ACQUIRE, &train, inter});
+            return true;
+        }
+        return !current_loop->acquire(train, inter);
+    }
+
+    bool await_resume() {
+        bool granted = !train.denied;
+        train.denied = false;
+        return granted;
+    }
+};
+
+// Suspends the train for ms of simulation time on the loop it is on
+struct Traverse {
+    long ms;
+
+    bool await_ready() const noexcept { return ms <= 0; }
+    void await_suspend(std::coroutine_handle<> h) { current_loop->sleep_until(current_loop->now + ms, h); }
+    void await_resume() {}
+};
+
+static void release(TrainState& train, int inter) {
+    auto it = std::find(train.held.begin(), train.held.end(), inter);
+    if (it != train.held.end()) train.held.erase(it);
+    int owner = sim.intersections[inter].owner;
+    if (owner == current_loop->index) {
+        current_loop->release(train, inter);
+    } else {
+        sim.loops[owner]->post({LoopEvent::RELEASE, &train, inter});
+    }
+}
+
+static void release_all(TrainState& train) {
+    while (!train.held.empty()) release(train, train.held.back());
+}
+
+static void finish_train() {
+    if (++sim.finished == (long)sim.trains.size()) {
+        for (auto& loop : sim.loops) loop->wake();
+    }
+}
+
+// ---------------------------------------------------------------- trains
+
+// Same movement as run_train() in main.cpp: traverse the first intersection while holding on to it, acquire
+// the rest of the route, then release them all; a preempted train backs off and starts its route again.
+// Hop by hop holds one intersection at a time.
+static TrainTask run_train(TrainState& train) {
+    if (sim.movement == MOVE_HOP) {
+        for (int inter : train.route) {
+            // Holds nothing while it waits, so a denial is never a deadlock: back off and ask again
+            while (!co_await Acquire{train, inter}) co_await Traverse{sim.traverse_ms};
+            co_await Traverse{sim.traverse_ms};
+            release(train, inter);
+        }
+        co_return;
+    }
+
+    while (true) {
+        bool preempted = false;
+        for (size_t i = 0; i < train.route.size(); ++i) {
+            if (!co_await Acquire{train, train.route[i]}) {
+                preempted = true;
+                break;
+            }
+            if (i == 0) co_await Traverse{sim.traverse_ms};
+        }
+        if (!preempted) break;
+        train.restarts++;
+        co_await Traverse{sim.traverse_ms};
+    }
+    release_all(train);
+}
+
+// ---------------------------------------------------------------- event loop
+
+// Returns true if any event arrived
+bool EventLoop::drain_inbox() {
+    std::vector<LoopEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(inbox_mutex);
+        events.swap(inbox);
+    }
+    for (const LoopEvent& event : events) {
+        if (event.kind == LoopEvent::RELEASE) {
+            release(*event.train, event.inter);
+        } else if (acquire(*event.train, event.inter)) {
+            schedule(event.train->handle);
+        }
+    }
+    return !events.empty();
+}
+
+void EventLoop::run() {
+    current_loop = this;
+    long total = sim.trains.size();
+    next_detect = sim.detect_ms;
+    while (sim.finished < total) {
+        if (!sim.virtual_clock) now = clock_ms();
+        drain_inbox();
+        while (!ready.empty()) {
+            std::coroutine_handle<> h = ready.front();
+            ready.pop_front();
+            h.resume();
+        }
+        while (!timers.empty() && timers.top().due <= now) {
+            ready.push_back(timers.top().handle);
+            timers.pop();
+        }
+        if (now >= next_detect) {
+            // A train moving hop by hop never waits while holding, so it cannot deadlock
+            if (sim.movement == MOVE_HOLD_ALL) {
+                detect();
+                if (sim.loops.size() > 1) expire_cross_loop_waits();
+            }
+            next_detect = now + sim.detect_ms;
+        }
+        if (!ready.empty() || sim.finished >= total) continue;
+
+        long wake_at = next_detect;
+        if (!timers.empty()) wake_at = std::min(wake_at, timers.top().due);
+        if (sim.virtual_clock) {
+            now = wake_at; // Nothing can happen in between
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(inbox_mutex);
+        inbox_cv.wait_until(lock, sim.start + std::chrono::milliseconds(wake_at),
+                            [&] { return !inbox.empty() || sim.finished >= total; });
+    }
+}
+
+// Sparse form of the reduction in detect_deadlock(), over this loop's intersections: holders not queued
+// here can finish, a queued train can finish once its intersection has a free slot, and whatever is left
+// is deadlocked. Victims (most intersections held, like recover_from_deadlock()) are aborted until none is.
+void EventLoop::detect() {
+    detections++;
+    if (mark.empty()) {
+        mark.assign(sim.trains.size(), 0);
+        work.assign(sim.intersections.size(), 0);
+        scanned.assign(sim.intersections.size(), false);
+    }
+    if (++epoch == 0) {
+        std::fill(mark.begin(), mark.end(), 0);
+        epoch = 1;
+    }
+
+    std::vector<int> owned_waited;
+    std::vector<TrainState*> blocked;
+    for (size_t r = 0; r < sim.intersections.size(); ++r) {
+        IntersectionState& x = sim.intersections[r];
+        if (x.owner != index || x.waiting.empty()) continue;
+        owned_waited.push_back(r);
+        for (TrainState* w : x.waiting) {
+            mark[w->id - 1] = epoch;
+            blocked.push_back(w);
+        }
+    }
+    if (blocked.empty()) return;
+
+    std::vector<int> grown;
+    for (int r : owned_waited) {
+        IntersectionState& x = sim.intersections[r];
+        work[r] = x.capacity - (int)x.holders.size();
+        scanned[r] = false;
+    }
+    // Intersections without waiters only matter as the holds a finishing train gives back, and nothing
+    // waits on them, so only the waited ones are tracked
+    for (int r : owned_waited) {
+        for (TrainState* h : sim.intersections[r].holders) {
+            if (mark[h->id - 1] != epoch) work[r]++;
+        }
+        if (work[r] > 0) grown.push_back(r);
+    }
+
+    auto finish = [&](TrainState* t) {
+        mark[t->id - 1] = 0;
+        for (int hr : t->held) {
+            IntersectionState& x = sim.intersections[hr];
+            if (x.owner != index || x.waiting.empty()) continue;
+            if (++work[hr] == 1) grown.push_back(hr);
+        }
+    };
+
+    std::vector<TrainState*> victims;
+    bool candidates_sorted = false;
+    size_t next_candidate = 0;
+    size_t remaining = blocked.size();
+    while (true) {
+        while (!grown.empty()) {
+            int r = grown.back();
+            grown.pop_back();
+            if (scanned[r]) continue;
+            scanned[r] = true;
+            for (TrainState* w : sim.intersections[r].waiting) {
+                if (mark[w->id - 1] == epoch) {
+                    finish(w);
+                    remaining--;
+                }
+            }
+        }
+        if (remaining == 0) break;
+
+        if (!candidates_sorted) {
+            // Holdings do not change during the pass, so one sort orders every victim choice
+            std::stable_sort(blocked.begin(), blocked.end(),
+                             [](const TrainState* a, const TrainState* b) { return a->held.size() > b->held.size(); });
+            candidates_sorted = true;
+        }
+        while (mark[blocked[next_candidate]->id - 1] != epoch) next_candidate++;
+        TrainState* victim = blocked[next_candidate];
+        // Its holds go back to the reduction now; releasing them for real grants waiters, which
+        // would change the queues under the reduction, so that waits until it is done
+        finish(victim);
+        remaining--;
+        victims.push_back(victim);
+    }
+    for (TrainState* victim : victims) abort_train(*victim);
+}
+
+// Takes the victim out of the queue, releases everything it holds and resumes it with a denial
+void EventLoop::abort_train(TrainState& victim) {
+    auto& q = sim.intersections[victim.waiting_on].waiting;
+    q.erase(std::find(q.begin(), q.end(), &victim));
+    victim.waiting_on = -1;
+    aborts++;
+    release_all(victim);
+    victim.denied = true;
+    schedule(victim.handle);
+}
+
+// A cycle through intersections of several loops is invisible to each of them; like the sharded
+// server, the oldest waiter past its timeout is assumed to be in one
+void EventLoop::expire_cross_loop_waits() {
+    TrainState* oldest = nullptr;
+    for (size_t r = 0; r < sim.intersections.size(); ++r) {
+        IntersectionState& x = sim.intersections[r];
+        if (x.owner != index) continue;
+        for (TrainState* w : x.waiting) {
+            long timeout = CROSS_LOOP_TIMEOUT_MS + (w->id % 8) * sim.detect_ms;
+            if (now - w->wait_start >= timeout && (!oldest || w->wait_start < oldest->wait_start)) {
+                oldest = w;
+            }
+        }
+    }
+    if (oldest) abort_train(*oldest);
+}
+
+// ---------------------------------------------------------------- setup
+
+static long rss_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// TRAINS,INTERSECTIONS,HOPS: capacities 1-3 and routes of distinct intersections, from the seed
+static bool build_synthetic(const std::string& spec, unsigned seed) {
+    long num_trains = 0, num_inters = 0, hops = 0;
+    if (sscanf(spec.c_str(), "%ld,%ld,%ld", &num_trains, &num_inters, &hops) != 3 || num_trains < 1 ||
+        num_inters < 1 || hops < 1 || hops > num_inters) {
+        std::cerr << "Error: --synthetic wants TRAINS,INTERSECTIONS,HOPS\n";
+        return false;
+    }
+    std::mt19937 rng(seed);
+    for (long i = 0; i < num_inters; ++i) {
+        sim.intersections.push_back({"Intersection" + std::to_string(i + 1), 1 + (int)(rng() % 3), 0, {}, {}});
+    }
+    sim.trains.resize(num_trains);
+    for (long t = 0; t < num_trains; ++t) {
+        TrainState& train = sim.trains[t];
+        train.id = t + 1;
+        while ((long)train.route.size() < hops) {
+            int inter = rng() % num_inters;
+            if (std::find(train.route.begin(), train.route.end(), inter) == train.route.end()) {
+                train.route.push_back(inter);
+            }
+        }
+    }
+    return true;
+}
+
+static bool load_files(const std::string& inter_path, const std::string& train_path) {
+    auto parsed = parseIntersections(inter_path);
+    std::vector<TrainRoute> routes = parseTrains(train_path);
+    if (parsed.empty() || routes.empty()) return false;
+
+    // Sorted by name so the indices do not depend on the hash map
+    std::vector<std::string> names;
+    for (const auto& entry : parsed) names.push_back(entry.first);
+    std::sort(names.begin(), names.end());
+    std::unordered_map<std::string, int> index;
+    for (const std::string& name : names) {
+        index[name] = sim.intersections.size();
+        sim.intersections.push_back({name, parsed[name].capacity, 0, {}, {}});
+    }
+
+    sim.trains.resize(routes.size());
+    for (size_t t = 0; t < routes.size(); ++t) {
+        sim.trains[t].id = t + 1;
+        for (const std::string& name : routes[t].route) {
+            auto it = index.find(name);
+            if (it == index.end()) {
+                std::cerr << "Warning: " << routes[t].trainName << " skips unknown intersection " << name << std::endl;
+                continue;
+            }
+            sim.trains[t].route.push_back(it->second);
+        }
+    }
+    return true;
+}
+
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [intersections.txt] [trains.txt] [--loops=N] [--traverse-ms=MS]"
+              << " [--movement=hold|hop] [--clock=virtual|real] [--detect-ms=MS]"
+              << " [--synthetic=TRAINS,INTERSECTIONS,HOPS] [--seed=N]\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> files;
+    std::string synthetic;
+    std::string clock;
+    int num_loops = 1;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--loops=", 0) == 0) {
+            num_loops = atoi(arg.c_str() + 8);
+        } else if (arg.rfind("--traverse-ms=", 0) == 0) {
+            sim.traverse_ms = atol(arg.c_str() + 14);
+        } else if (arg.rfind("--detect-ms=", 0) == 0) {
+            sim.detect_ms = atol(arg.c_str() + 12);
+        } else if (arg == "--movement=hold") {
+            sim.movement = MOVE_HOLD_ALL;
+        } else if (arg == "--movement=hop") {
+            sim.movement = MOVE_HOP;
+        } else if (arg.rfind("--clock=", 0) == 0) {
+            clock = arg.substr(8);
+        } else if (arg.rfind("--synthetic=", 0) == 0) {
+            synthetic = arg.substr(12);
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            seed = strtoul(arg.c_str() + 7, nullptr, 10);
+        } else if (arg[0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (num_loops < 1 || sim.detect_ms < 1 || (clock != "" && clock != "virtual" && clock != "real")) {
+        usage(argv[0]);
+        return 1;
+    }
+    sim.virtual_clock = clock.empty() ? num_loops == 1 : clock == "virtual";
+    if (sim.virtual_clock && num_loops > 1) {
+        std::cerr << "Error: the virtual clock needs --loops=1, loops on several cores share the real one\n";
+        return 1;
+    }
+
+    long rss_before = rss_bytes();
+    bool loaded = synthetic.empty()
+        ? load_files(files.size() > 0 ? files[0] : "intersections.txt", files.size() > 1 ? files[1] : "trains.txt")
+        : build_synthetic(synthetic, seed);
+    if (!loaded) return 1;
+
+    for (int l = 0; l < num_loops; ++l) sim.loops.emplace_back(new EventLoop(l));
+    for (IntersectionState& x : sim.intersections) x.owner = shard_of(x.name, num_loops);
+
+    // Every train starts on loop 0 and moves as soon as it asks another loop for an intersection
+    current_loop = sim.loops[0].get();
+    for (TrainState& train : sim.trains) {
+        current_loop->schedule(run_train(train).handle);
+    }
+    long rss_ready = rss_bytes();
+    long train_bytes = (rss_ready - rss_before) / (long)sim.trains.size();
+
+    auto wall_start = std::chrono::steady_clock::now();
+    sim.start = wall_start;
+    std::vector<std::thread> threads;
+    for (int l = 1; l < num_loops; ++l) threads.emplace_back(&EventLoop::run, sim.loops[l].get());
+    sim.loops[0]->run();
+    for (std::thread& t : threads) t.join();
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+
+    long grants = 0, aborts = 0, detections = 0, makespan = 0, restarts = 0;
+    for (auto& loop : sim.loops) {
+        grants += loop->grants;
+        aborts += loop->aborts;
+        detections += loop->detections;
+        makespan = std::max(makespan, loop->now);
+    }
+    long hops = 0;
+    for (const TrainState& train : sim.trains) {
+        restarts += train.restarts;
+        hops += train.route.size();
+    }
+
+    std::cout << "Trains:           " << sim.trains.size() << " on " << sim.intersections.size() << " intersections, "
+              << num_loops << (num_loops == 1 ? " loop" : " loops") << " (" << (sim.virtual_clock ? "virtual" : "real")
+              << " clock)\n";
+    std::cout << "Simulated time:   " << makespan << " ms\n";
+    std::cout << "Wall time:        " << wall_s << " s\n";
+    std::cout << "Grants:           " << grants << " (" << (long)(grants / std::max(wall_s, 1e-9)) << "/s)\n";
+    std::cout << "Deadlock passes:  " << detections << ", " << aborts << " victims, " << restarts << " restarts\n";
+    std::cout << "Frame per train:  " << frame_bytes << " bytes\n";
+    std::cout << "Memory per train: " << train_bytes << " bytes (resident after setup, network included)\n";
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << "Peak resident:    " << usage.ru_maxrss / 1024 << " MiB\n";
+    if (sim.finished != (long)sim.trains.size()) return 1;
+
+    // Every hop is granted exactly once, plus the holds a restarted hold-all train gave up
+    bool complete = sim.movement == MOVE_HOP ? grants == hops : grants >= hops;
+    if (!complete) {
+        std::cerr << "Error: " << grants << " grants for " << hops << " route hops\n";
+        return 1;
+    }
+    return 0;
+}
@@ -5,13 +5,17 @@
 // Description: Implements deadlock detection using a Resource Allocation Table and Banker's Algorithm, and recovery via victim termination.
 
 #include "detect_deadlock.h"
+#include "detect_fixed.h"
 #include "sync.h"
 #include "log.h"
+#include "thread_pool.h"
 #include <iostream>
 #include <vector>
 #include <string>
 #include <numeric>
 #include <algorithm>
+#include <atomic>
+#include <memory>
 
 using namespace std;
 
@@ -19,11 +23,11 @@ bool detect_deadlock(const vector<vector<int>>& allocation,
                      const vector<vector<int>>& request,
                      const vector<int>& available)
 {
-    std::cout << "[DEBUG] Running deadlock detection check...\n";
-
     int n = allocation.size();
     int m = available.size();
     vector<bool> finish(n, false);
+    // work can start negative after a reload shrank a capacity below its holders, so a resource
+    // only blocks trains that actually request it
     vector<int> work = available;
 
     bool made_progress;
@@ -33,7 +37,7 @@ bool detect_deadlock(const vector<vector<int>>& allocation,
             if (!finish[i]) {
                 bool can_proceed = true;
                 for (int j = 0; j < m; j++) {
-                    if (request[i][j] > work[j]) {
+                    if (request[i][j] > 0 && request[i][j] > work[j]) {
                         can_proceed = false;
                         break;
                     }
@@ -55,27 +59,280 @@ bool detect_deadlock(const vector<vector<int>>& allocation,
     return false;
 }
 
+// Same reduction as above, restricted to one component of the resource graph
+bool detect_deadlock(const vector<vector<int>>& allocation,
+                     const vector<vector<int>>& request,
+                     const vector<int>& available,
+                     const vector<int>& trains,
+                     const vector<int>& resources)
+{
+    int n = trains.size();
+    int m = resources.size();
+    vector<bool> finish(n, false);
+    vector<int> work(m);
+    for (int k = 0; k < m; k++) {
+        work[k] = available[resources[k]];
+    }
+
+    bool made_progress;
+    do {
+        made_progress = false;
+        for (int i = 0; i < n; i++) {
+            if (!finish[i]) {
+                const vector<int>& req = request[trains[i]];
+                bool can_proceed = true;
+                for (int k = 0; k < m; k++) {
+                    if (req[resources[k]] > 0 && req[resources[k]] > work[k]) {
+                        can_proceed = false;
+                        break;
+                    }
+                }
+                if (can_proceed) {
+                    const vector<int>& alloc = allocation[trains[i]];
+                    for (int k = 0; k < m; k++) {
+                        work[k] += alloc[resources[k]];
+                    }
+                    finish[i] = true;
+                    made_progress = true;
+                }
+            }
+        }
+    } while (made_progress);
+
+    for (int i = 0; i < n; i++) {
+        if (!finish[i]) return true;
+    }
+    return false;
+}
+
+// Copies the scope into an N x M table. Trains past the scope hold and want nothing, so they finish
+// at once; intersections past it are never requested. Fails if a count does not fit in one bit.
+template <size_t N, size_t M>
+static bool fill_fixed_table(const vector<vector<int>>& allocation,
+                             const vector<vector<int>>& request,
+                             const vector<int>& available,
+                             const vector<int>& trains,
+                             const vector<int>& resources,
+                             FixedResourceTable<N, M>& table)
+{
+    for (size_t i = 0; i < trains.size(); i++) {
+        const vector<int>& alloc = allocation[trains[i]];
+        const vector<int>& req = request[trains[i]];
+        for (size_t k = 0; k < resources.size(); k++) {
+            int held = alloc[resources[k]];
+            int wanted = req[resources[k]];
+            if (held < 0 || held > 1 || wanted < 0 || wanted > 1) return false;
+            table.allocation[i] |= (uint64_t)held << k;
+            table.request[i] |= (uint64_t)wanted << k;
+        }
+    }
+    for (size_t k = 0; k < resources.size(); k++) {
+        table.available[k] = available[resources[k]];
+    }
+    return true;
+}
+
+template <size_t N, size_t M>
+static bool try_fixed(const vector<vector<int>>& allocation,
+                      const vector<vector<int>>& request,
+                      const vector<int>& available,
+                      const vector<int>& trains,
+                      const vector<int>& resources,
+                      bool& deadlock)
+{
+    if (trains.size() > N || resources.size() > M) return false;
+    FixedResourceTable<N, M> table;
+    if (!fill_fixed_table(allocation, request, available, trains, resources, table)) return false;
+    deadlock = detect_deadlock(table);
+    return true;
+}
+
+bool detect_deadlock_dispatch(const vector<vector<int>>& allocation,
+                              const vector<vector<int>>& request,
+                              const vector<int>& available,
+                              const vector<int>& trains,
+                              const vector<int>& resources)
+{
+    bool deadlock = false;
+    if (try_fixed<4, 4>(allocation, request, available, trains, resources, deadlock) ||
+        try_fixed<8, 8>(allocation, request, available, trains, resources, deadlock) ||
+        try_fixed<16, 16>(allocation, request, available, trains, resources, deadlock)) {
+        return deadlock;
+    }
+    return detect_deadlock(allocation, request, available, trains, resources);
+}
+
+bool detect_deadlock_parallel(const vector<vector<int>>& allocation,
+                              const vector<vector<int>>& request,
+                              const vector<int>& available,
+                              ThreadPool& pool)
+{
+    vector<int> trains(allocation.size());
+    vector<int> resources(available.size());
+    iota(trains.begin(), trains.end(), 0);
+    iota(resources.begin(), resources.end(), 0);
+    return detect_deadlock_parallel(allocation, request, available, trains, resources, pool);
+}
+
+// The set of trains that can finish is the unique fixed point of the serial loop, so it can be
+// reached in any order. Each round finishes the whole frontier, returns its allocations, and
+// wakes only the waiters of resources whose work grew.
+bool detect_deadlock_parallel(const vector<vector<int>>& allocation,
+                              const vector<vector<int>>& request,
+                              const vector<int>& available,
+                              const vector<int>& trains,
+                              const vector<int>& resources,
+                              ThreadPool& pool)
+{
+    int n = trains.size();
+    int m = resources.size();
+    int num_workers = pool.size();
+    vector<long> work(m);
+    for (int k = 0; k < m; k++) {
+        work[k] = available[resources[k]];
+    }
+
+    // First pass: how many resources each train is short of, and which ones
+    unique_ptr<atomic<int>[]> blocked(new atomic<int>[n]);
+    vector<vector<pair<int, int>>> local_short(num_workers);
+    vector<vector<int>> local_ready(num_workers);
+    pool.parallel_for(n, [&](int w, int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            const vector<int>& req = request[trains[i]];
+            int short_of = 0;
+            for (int k = 0; k < m; k++) {
+                if (req[resources[k]] > 0 && req[resources[k]] > work[k]) {
+                    short_of++;
+                    local_short[w].push_back({k, i});
+                }
+            }
+            blocked[i].store(short_of, memory_order_relaxed);
+            if (short_of == 0) local_ready[w].push_back(i);
+        }
+    });
+
+    // Waiters per resource, smallest request first, so a grown resource wakes a prefix
+    vector<vector<int>> waiters(m);
+    for (int w = 0; w < num_workers; w++) {
+        for (const pair<int, int>& p : local_short[w]) {
+            waiters[p.first].push_back(p.second);
+        }
+        vector<pair<int, int>>().swap(local_short[w]);
+    }
+    pool.parallel_for(m, [&](int, int begin, int end) {
+        for (int k = begin; k < end; k++) {
+            int col = resources[k];
+            sort(waiters[k].begin(), waiters[k].end(), [&](int a, int b) {
+                return request[trains[a]][col] < request[trains[b]][col];
+            });
+        }
+    });
+    vector<size_t> next_waiter(m, 0);
+
+    vector<vector<long>> local_delta(num_workers, vector<long>(m, 0));
+    vector<vector<int>> local_touched(num_workers);
+    vector<char> grown_flag(m, 0);
+    vector<int> frontier;
+    vector<int> grown;
+    int finished = 0;
+
+    while (true) {
+        frontier.clear();
+        for (int w = 0; w < num_workers; w++) {
+            frontier.insert(frontier.end(), local_ready[w].begin(), local_ready[w].end());
+            local_ready[w].clear();
+        }
+        if (frontier.empty()) break;
+        finished += frontier.size();
+
+        // Finishing trains return everything they hold
+        pool.parallel_for(frontier.size(), [&](int w, int begin, int end) {
+            for (int f = begin; f < end; f++) {
+                const vector<int>& alloc = allocation[trains[frontier[f]]];
+                for (int k = 0; k < m; k++) {
+                    int amount = alloc[resources[k]];
+                    if (amount == 0) continue;
+                    if (local_delta[w][k] == 0) local_touched[w].push_back(k);
+                    local_delta[w][k] += amount;
+                }
+            }
+        });
+
+        grown.clear();
+        for (int w = 0; w < num_workers; w++) {
+            for (int k : local_touched[w]) {
+                work[k] += local_delta[w][k];
+                local_delta[w][k] = 0;
+                if (!grown_flag[k]) {
+                    grown_flag[k] = 1;
+                    grown.push_back(k);
+                }
+            }
+            local_touched[w].clear();
+        }
+
+        // Re-examine only the trains waiting on resources that grew
+        pool.parallel_for(grown.size(), [&](int w, int begin, int end) {
+            for (int g = begin; g < end; g++) {
+                int k = grown[g];
+                int col = resources[k];
+                const vector<int>& list = waiters[k];
+                size_t& next = next_waiter[k];
+                while (next < list.size() && request[trains[list[next]]][col] <= work[k]) {
+                    if (blocked[list[next]].fetch_sub(1, memory_order_relaxed) == 1) {
+                        local_ready[w].push_back(list[next]);
+                    }
+                    next++;
+                }
+            }
+        });
+        for (int k : grown) {
+            grown_flag[k] = 0;
+        }
+    }
+
+    return finished < n;
+}
+
 // Angel's Deadlock Recovery
 void recover_from_deadlock(vector<vector<int>>& allocation,
                            vector<vector<int>>& request,
                            vector<int>& available,
                            SharedMemory* shm,
                            Logger& logger)
+{
+    vector<int> all_trains(allocation.size());
+    iota(all_trains.begin(), all_trains.end(), 0);
+    recover_from_deadlock(allocation, request, available, shm, logger, all_trains);
+}
+
+int choose_victim(const vector<vector<int>>& allocation, const vector<int>& candidates)
 {
     int victim_train = -1;
     int max_holding = -1;
 
-    for (int train_id = 0; train_id < allocation.size(); ++train_id) {
+    for (int train_id : candidates) {
         int holding = accumulate(allocation[train_id].begin(), allocation[train_id].end(), 0);
         if (holding > max_holding) {
             max_holding = holding;
             victim_train = train_id;
         }
     }
+    return victim_train;
+}
+
+int recover_from_deadlock(vector<vector<int>>& allocation,
+                          vector<vector<int>>& request,
+                          vector<int>& available,
+                          SharedMemory* shm,
+                          Logger& logger,
+                          const vector<int>& candidates)
+{
+    int victim_train = choose_victim(allocation, candidates);
 
     if (victim_train == -1) {
         logger.log_server("Deadlock detected.");
-        return;
+        return -1;
     }
 
     logger.log_server("Recovering from deadlock: Terminating Train" + to_string(victim_train + 1));
@@ -95,4 +352,5 @@ void recover_from_deadlock(vector<vector<int>>& allocation,
 
     fill(request[victim_train].begin(), request[victim_train].end(), 0);
     logger.log_server("Train" + to_string(victim_train + 1) + " released all locks.");
+    return victim_train;
 }
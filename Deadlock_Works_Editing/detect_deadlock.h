@@ -10,9 +10,10 @@
 #include <vector>
 #include <string>
 
-// Forward declarations for shared memory and logger
+// Forward declarations for shared memory, logger and thread pool
 struct SharedMemory;
 class Logger;
+class ThreadPool;
 
 // Detects if a deadlock exists in the system.
 // Returns true if deadlock detected, false otherwise.
@@ -20,6 +21,36 @@ bool detect_deadlock(const std::vector<std::vector<int>>& allocation,
                      const std::vector<std::vector<int>>& request,
                      const std::vector<int>& available);
 
+// Detects a deadlock among only the given trains and intersections (one connected
+// component of the resource graph). Rows and columns outside the scope are ignored.
+bool detect_deadlock(const std::vector<std::vector<int>>& allocation,
+                     const std::vector<std::vector<int>>& request,
+                     const std::vector<int>& available,
+                     const std::vector<int>& trains,
+                     const std::vector<int>& resources);
+
+// Same as the scoped detect_deadlock, but a scope of at most 16 trains and 16 intersections runs
+// on the compile-time specialized detector in detect_fixed.h (padded up to 4, 8 or 16 of each)
+bool detect_deadlock_dispatch(const std::vector<std::vector<int>>& allocation,
+                              const std::vector<std::vector<int>>& request,
+                              const std::vector<int>& available,
+                              const std::vector<int>& trains,
+                              const std::vector<int>& resources);
+
+// Parallel worklist variant for very large train counts; gives the same answer as
+// detect_deadlock. "Can this train finish" checks are split across the pool, and after
+// the first pass only trains waiting on resources that were just returned are re-examined.
+bool detect_deadlock_parallel(const std::vector<std::vector<int>>& allocation,
+                              const std::vector<std::vector<int>>& request,
+                              const std::vector<int>& available,
+                              ThreadPool& pool);
+
+bool detect_deadlock_parallel(const std::vector<std::vector<int>>& allocation,
+                              const std::vector<std::vector<int>>& request,
+                              const std::vector<int>& available,
+                              const std::vector<int>& trains,
+                              const std::vector<int>& resources,
+                              ThreadPool& pool);
 
 // Angels Recovery Code
 void recover_from_deadlock(std::vector<std::vector<int>>& allocation,
@@ -28,4 +59,16 @@ void recover_from_deadlock(std::vector<std::vector<int>>& allocation,
     SharedMemory* shm,
     Logger& logger);
 
+// The candidate holding the most intersections, or -1 if there is none. Changes nothing.
+int choose_victim(const std::vector<std::vector<int>>& allocation, const std::vector<int>& candidates);
+
+// Recovery limited to candidate trains, so the victim is picked from the deadlocked component.
+// Returns the victim's train index, or -1 if there was no candidate.
+int recover_from_deadlock(std::vector<std::vector<int>>& allocation,
+    std::vector<std::vector<int>>& request,
+    std::vector<int>& available,
+    SharedMemory* shm,
+    Logger& logger,
+    const std::vector<int>& candidates);
+
 #endif // DETECT_DEADLOCK_H
\ No newline at end of file
@@ -0,0 +1,89 @@
+// Group : I
+// Author: Brandon Collings
+// Email: brandon.l.collings@okstate.edu
+// Date: 10/19/2026
+// Description: Deadlock detection specialized at compile time on the number of trains and intersections.
+// For small fixed topologies the matrices live on the stack as one bit mask per train, both loops are unrolled
+// by index_sequence folds, and the whole check is constexpr so it can be verified with static_assert.
+
+#ifndef DETECT_FIXED_H
+#define DETECT_FIXED_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// A train holds or requests at most one slot of an intersection, so each row is a bit mask
+// (bit j = intersection j). std::bitset would do, but its operations are not constexpr in C++17.
+template <size_t N, size_t M>
+struct FixedResourceTable {
+    static_assert(N >= 1 && M >= 1 && M <= 64, "one bit per intersection in a 64-bit mask");
+    std::array<uint64_t, N> allocation{};
+    std::array<uint64_t, N> request{};
+    std::array<int, M> available{};
+};
+
+namespace fixed_detail {
+
+// Intersections with at least one free slot
+template <size_t M, size_t... J>
+constexpr uint64_t free_mask(const std::array<int, M>& work, std::index_sequence<J...>) {
+    return ((work[J] > 0 ? uint64_t(1) << J : uint64_t(0)) | ... | uint64_t(0));
+}
+
+template <size_t M, size_t... J>
+constexpr void return_held(std::array<int, M>& work, uint64_t held, std::index_sequence<J...>) {
+    ((work[J] += (int)((held >> J) & 1)), ...);
+}
+
+template <size_t N, size_t M>
+struct Reduction {
+    std::array<int, M> work{};
+    std::array<bool, N> finished{};
+    uint64_t free = 0;
+
+    // Finishes train I if everything it requests has a free slot
+    template <size_t I>
+    constexpr bool try_finish(const FixedResourceTable<N, M>& table) {
+        if (finished[I] || (table.request[I] & ~free) != 0) return false;
+        finished[I] = true;
+        return_held(work, table.allocation[I], std::make_index_sequence<M>{});
+        free = free_mask(work, std::make_index_sequence<M>{});
+        return true;
+    }
+
+    // One pass over every train, in order, like the vector version. Returns true if any finished.
+    template <size_t... I>
+    constexpr bool pass(const FixedResourceTable<N, M>& table, std::index_sequence<I...>) {
+        bool progress = false;
+        ((progress = try_finish<I>(table) || progress), ...);
+        return progress;
+    }
+
+    // Each pass that makes progress finishes at least one train, so N passes reach the fixed point.
+    // The && fold stops at the first pass without progress.
+    template <size_t... P>
+    constexpr void run(const FixedResourceTable<N, M>& table, std::index_sequence<P...>) {
+        (((void)P, pass(table, std::make_index_sequence<N>{})) && ...);
+    }
+
+    template <size_t... I>
+    constexpr bool all_finished(std::index_sequence<I...>) const {
+        return (finished[I] && ...);
+    }
+};
+
+} // namespace fixed_detail
+
+// Same answer as detect_deadlock() on the same matrices: true if some train can never finish
+template <size_t N, size_t M>
+constexpr bool detect_deadlock(const FixedResourceTable<N, M>& table) {
+    fixed_detail::Reduction<N, M> reduction;
+    reduction.work = table.available;
+    reduction.free = fixed_detail::free_mask(reduction.work, std::make_index_sequence<M>{});
+    reduction.run(table, std::make_index_sequence<N>{});
+    return !reduction.all_finished(std::make_index_sequence<N>{});
+}
+
+#endif // DETECT_FIXED_H
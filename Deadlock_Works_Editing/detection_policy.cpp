@@ -0,0 +1,135 @@
+// Group : I
+// Author: Brandon Collings
+// Email: brandon.l.collings@okstate.edu
+// Date: 10/19/2026
+// Description: Implements the deadlock detection scheduling policy and the detection overhead report.
+
+#include "detection_policy.h"
+#include "log.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+bool parse_detection_policy(const std::string& spec, DetectionPolicy& policy) {
+    if (spec == "request") {
+        policy.mode = DETECT_EVERY_REQUEST;
+        return true;
+    }
+
+    size_t colonPos = spec.find(':');
+    if (colonPos == std::string::npos) {
+        return false;
+    }
+
+    std::string kind = spec.substr(0, colonPos);
+    long value;
+    try {
+        value = std::stol(spec.substr(colonPos + 1));
+    } catch (...) {
+        return false;
+    }
+    if (value <= 0) {
+        return false;
+    }
+
+    if (kind == "count") {
+        policy.mode = DETECT_EVERY_N;
+        policy.every_n = value;
+    } else if (kind == "wall") {
+        policy.mode = DETECT_WALL_INTERVAL;
+        policy.interval = value;
+    } else if (kind == "virtual") {
+        policy.mode = DETECT_VIRTUAL_INTERVAL;
+        policy.interval = value;
+    } else if (kind == "wait") {
+        policy.mode = DETECT_WAIT_THRESHOLD;
+        policy.wait_threshold_ms = value;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string describe_detection_policy(const DetectionPolicy& policy) {
+    switch (policy.mode) {
+        case DETECT_EVERY_REQUEST:    return "every request";
+        case DETECT_EVERY_N:          return "every " + std::to_string(policy.every_n) + " requests";
+        case DETECT_WALL_INTERVAL:    return "every " + std::to_string(policy.interval) + " ms";
+        case DETECT_VIRTUAL_INTERVAL: return "every " + std::to_string(policy.interval) + " sim ticks";
+        case DETECT_WAIT_THRESHOLD:   return "when a train waits " + std::to_string(policy.wait_threshold_ms) + " ms";
+    }
+    return "unknown";
+}
+
+long detection_tick_ms(const DetectionPolicy& policy) {
+    switch (policy.mode) {
+        case DETECT_EVERY_REQUEST:    return 0;
+        case DETECT_WALL_INTERVAL:    return policy.interval;
+        case DETECT_WAIT_THRESHOLD:   return policy.wait_threshold_ms / 4 > 0 ? policy.wait_threshold_ms / 4 : 1;
+        // Request counts and sim time both stop advancing once every train is blocked,
+        // so these modes fall back to a wall-clock backstop to stay live
+        case DETECT_EVERY_N:
+        case DETECT_VIRTUAL_INTERVAL: return policy.idle_backstop_ms;
+    }
+    return 0;
+}
+
+bool detection_due(const DetectionPolicy& policy, long now_ms, long now_sim, long oldest_wait_ms) {
+    // Nothing has changed since the last check, so the answer cannot have changed either
+    if (policy.requests_since_check == 0) {
+        return false;
+    }
+
+    switch (policy.mode) {
+        case DETECT_EVERY_REQUEST:
+            return true;
+        case DETECT_EVERY_N:
+            return policy.requests_since_check >= policy.every_n
+                || now_ms - policy.last_check_ms >= policy.idle_backstop_ms;
+        case DETECT_WALL_INTERVAL:
+            return now_ms - policy.last_check_ms >= policy.interval;
+        case DETECT_VIRTUAL_INTERVAL:
+            return now_sim - policy.last_check_sim >= policy.interval
+                || now_ms - policy.last_check_ms >= policy.idle_backstop_ms;
+        case DETECT_WAIT_THRESHOLD:
+            return oldest_wait_ms >= policy.wait_threshold_ms;
+    }
+    return true;
+}
+
+void detection_ran(DetectionPolicy& policy, long now_ms, long now_sim) {
+    policy.requests_since_check = 0;
+    policy.last_check_ms = now_ms;
+    policy.last_check_sim = now_sim;
+}
+
+void report_detection_overhead(const DetectionPolicy& policy, const DetectionOverhead& overhead, Logger& logger) {
+    long total_ns = overhead.detect_cpu_ns + overhead.grant_cpu_ns;
+    double detect_pct = total_ns > 0 ? 100.0 * overhead.detect_cpu_ns / total_ns : 0.0;
+    double avg_recover_ms = overhead.deadlocks > 0 ? (double)overhead.recover_wait_ms_total / overhead.deadlocks : 0.0;
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3)
+        << "Detection policy: " << describe_detection_policy(policy)
+        << " (" << policy.threads << (policy.threads == 1 ? " thread)" : " threads)")
+        << " | requests=" << overhead.requests
+        << " batches=" << overhead.batches
+        << " (avg " << std::setprecision(1) << (overhead.batches > 0 ? (double)overhead.requests / overhead.batches : 0.0)
+        << " max " << overhead.max_batch << ")" << std::setprecision(3)
+        << " checks=" << overhead.checks
+        << " deadlocks=" << overhead.deadlocks
+        << " largest component=" << overhead.max_component_trains << " trains"
+        << " (rebuilt " << overhead.component_rebuilds << "x)"
+        << " | detect cpu=" << overhead.detect_cpu_ns / 1e6 << " ms"
+        << " grant cpu=" << overhead.grant_cpu_ns / 1e6 << " ms"
+        << " (" << std::setprecision(1) << detect_pct << "% detecting)"
+        << " | time-to-recover avg=" << avg_recover_ms << " ms max=" << overhead.recover_wait_ms_max << " ms";
+    if (overhead.timeouts > 0) {
+        oss << " | timeouts=" << overhead.timeouts
+            << " avg=" << (double)overhead.timeout_wait_ms_total / overhead.timeouts << " ms"
+            << " max=" << overhead.timeout_wait_ms_max << " ms";
+    }
+
+    std::cout << "[STATS] " << oss.str() << std::endl;
+    logger.log_server(oss.str());
+}
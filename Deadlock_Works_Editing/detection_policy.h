@@ -0,0 +1,71 @@
+// Group : I
+// Author: Brandon Collings
+// Email: brandon.l.collings@okstate.edu
+// Date: 10/19/2026
+// Description: Declares the policy that decides when the server runs deadlock detection, and the counters used to weigh detection cost against grant work.
+
+#ifndef DETECTION_POLICY_H
+#define DETECTION_POLICY_H
+
+#include <string>
+
+class Logger;
+
+enum DetectionMode {
+    DETECT_EVERY_REQUEST,   // check on every acquire and release (original behaviour)
+    DETECT_EVERY_N,         // check once every N requests
+    DETECT_WALL_INTERVAL,   // check every T milliseconds of wall time
+    DETECT_VIRTUAL_INTERVAL,// check every T ticks of simulation time
+    DETECT_WAIT_THRESHOLD   // check only once some train has waited T milliseconds
+};
+
+struct DetectionPolicy {
+    DetectionMode mode = DETECT_EVERY_REQUEST;
+    long every_n = 1;
+    long interval = 0;          // ms (wall) or ticks (virtual)
+    long wait_threshold_ms = 0;
+    long idle_backstop_ms = 1000; // deferred modes still check this often while requests are unchecked
+    int threads = 1;              // > 1 uses the parallel detector on large components
+    long parallel_min_trains = 1024;
+
+    long requests_since_check = 0;
+    long last_check_ms = 0;
+    long last_check_sim = 0;
+};
+
+// CPU spent by the server on detection versus on granting and releasing
+struct DetectionOverhead {
+    long requests = 0;
+    long batches = 0;               // receives that drained at least one request
+    long max_batch = 0;
+    long checks = 0;
+    long deadlocks = 0;
+    long detect_cpu_ns = 0;         // detectors and victim choice only, not the release, grants or logging after
+    long grant_cpu_ns = 0;          // applying batches, and handing a victim's holds on
+    long recover_wait_ms_total = 0; // how long victims had been waiting when recovered
+    long recover_wait_ms_max = 0;
+    long component_rebuilds = 0;
+    long max_component_trains = 0;  // largest component detection had to scan
+    long timeouts = 0;              // cross-shard timeout aborts, kept apart from detected deadlocks
+    long timeout_wait_ms_total = 0;
+    long timeout_wait_ms_max = 0;
+};
+
+// Parses "request", "count:N", "wall:MS", "virtual:TICKS" or "wait:MS". Returns false on a bad spec.
+bool parse_detection_policy(const std::string& spec, DetectionPolicy& policy);
+
+std::string describe_detection_policy(const DetectionPolicy& policy);
+
+// How often the server should wake up to re-evaluate the policy while idle (0 = never)
+long detection_tick_ms(const DetectionPolicy& policy);
+
+// Returns true when a check is due. oldest_wait_ms is the longest current wait, or -1 if none.
+bool detection_due(const DetectionPolicy& policy, long now_ms, long now_sim, long oldest_wait_ms);
+
+// Resets the counters after a check has run
+void detection_ran(DetectionPolicy& policy, long now_ms, long now_sim);
+
+// Writes the overhead summary to the log and stdout
+void report_detection_overhead(const DetectionPolicy& policy, const DetectionOverhead& overhead, Logger& logger);
+
+#endif // DETECTION_POLICY_H
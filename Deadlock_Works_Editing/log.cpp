@@ -2,16 +2,55 @@
 // Author: Angel Trujillo
 // Date: 04/01/2025
 // Description: Implements the Logger class. Provides synchronized logging with formatted timestamps and PID tagging.
+// In segment mode each process buffers its own lines and the segments are k-way merged by simulation time at the end.
 
 #include "log.h"
+#include "lz_codec.h"
 #include <iomanip>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <queue>
+#include <memory>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
 #include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
 
-Logger::Logger(const std::string& filename, int* sim_time_ptr, pthread_mutex_t* time_mutex_ptr, bool pid_tag)
-    : sim_time(sim_time_ptr), time_mutex(time_mutex_ptr), include_pid(pid_tag)
+#define SEGMENT_FLUSH_BYTES (64 * 1024)
+#define SEGMENT_FLUSH_MS 1000
+#define LOG_BLOCK_BYTES (64 * 1024)
+#define LOG_BLOCK_MAGIC "TLZB"
+
+// Loggers with segments, flushed by an atexit handler that every forked child inherits
+static std::vector<Logger*> segment_loggers;
+
+static void flush_segment_loggers() {
+    for (Logger* logger : segment_loggers) logger->flush();
+}
+
+static long wall_ms() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+Logger::Logger(const std::string& filename, int* sim_time_ptr, pthread_mutex_t* time_mutex_ptr, bool pid_tag,
+               const LogOptions& options)
+    : sim_time(sim_time_ptr), time_mutex(time_mutex_ptr), include_pid(pid_tag), filename(filename), options(options)
 {
+    if (options.segments) {
+        static bool registered = false;
+        if (!registered) atexit(flush_segment_loggers);
+        registered = true;
+        segment_loggers.push_back(this);
+        return;
+    }
     log_file.open(filename, std::ios::out | std::ios::app);
     if (!log_file.is_open()) {
         std::cerr << "Failed to open log file.\n";
@@ -22,6 +61,37 @@ Logger::~Logger() {
     if (log_file.is_open()) {
         log_file.close();
     }
+    if (options.segments) {
+        flush();
+        if (segment_fd >= 0) close(segment_fd);
+        segment_loggers.erase(std::remove(segment_loggers.begin(), segment_loggers.end(), this), segment_loggers.end());
+    }
+}
+
+// Opens this process's segment. A forked child inherits the parent's descriptor and unwritten
+// lines; both belong to the parent, so they are dropped rather than written twice.
+void Logger::open_segment() {
+    buffer.clear();
+    if (segment_fd >= 0) close(segment_fd);
+    segment_pid = getpid();
+    std::string path = filename + "." + options.run_id + "." + std::to_string(segment_pid) + ".seg";
+    segment_fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (segment_fd < 0) {
+        perror(("open " + path).c_str());
+    }
+    last_flush_ms = wall_ms();
+}
+
+void Logger::flush() {
+    if (segment_pid != getpid()) return; // Nothing of ours yet
+    size_t written = 0;
+    while (segment_fd >= 0 && written < buffer.size()) {
+        ssize_t n = write(segment_fd, buffer.data() + written, buffer.size() - written);
+        if (n <= 0) break;
+        written += n;
+    }
+    buffer.clear();
+    last_flush_ms = wall_ms();
 }
 
 // Increments simulation time with mutex lock and returns the new time
@@ -50,12 +120,26 @@ std::string Logger::format_time(int seconds) {
 void Logger::log(const std::string& source, const std::string& message) {
     int time_now = increment_sim_time();
     std::string timestamp = format_time(time_now);
+    std::string line;
     if (include_pid) {
-        log_file << timestamp << " [PID " << getpid() << "] " << source << ": " << message << std::endl;
+        line = timestamp + " [PID " + std::to_string(getpid()) + "] " + source + ": " + message;
     } else {
-        log_file << timestamp << " " << source << ": " << message << std::endl;
+        line = timestamp + " " + source + ": " + message;
+    }
+
+    if (!options.segments) {
+        log_file << line << std::endl;
+        log_file.flush();
+        return;
+    }
+
+    // Segment record: the sim time (unique, it is bumped under the time mutex) is the merge key
+    if (segment_pid != getpid()) open_segment();
+    long now = wall_ms();
+    buffer += std::to_string(time_now) + "\t" + std::to_string(now) + "\t" + line + "\n";
+    if (buffer.size() >= SEGMENT_FLUSH_BYTES || now - last_flush_ms >= SEGMENT_FLUSH_MS) {
+        flush();
     }
-    log_file.flush();
 }
 
 void Logger::log_server(const std::string& message) {
@@ -65,3 +149,151 @@ void Logger::log_server(const std::string& message) {
 void Logger::log_train(const std::string& train_name, const std::string& message) {
     log(train_name, message);
 }
+
+// ---------------------------------------------------------------- merging
+
+// One segment, read a record at a time
+struct SegmentReader {
+    std::ifstream in;
+    long sim_time = 0;
+    long wall_ms = 0;
+    std::string line;
+
+    bool next() {
+        std::string record;
+        while (std::getline(in, record)) {
+            size_t tab1 = record.find('\t');
+            size_t tab2 = tab1 == std::string::npos ? tab1 : record.find('\t', tab1 + 1);
+            if (tab2 == std::string::npos) continue; // Torn last line of a killed process
+            sim_time = atol(record.c_str());
+            wall_ms = atol(record.c_str() + tab1 + 1);
+            line = record.substr(tab2 + 1);
+            return true;
+        }
+        return false;
+    }
+};
+
+// The merged log: plain or LZ blocks, rotated by size or age
+class LogWriter {
+public:
+    LogWriter(const std::string& filename, const LogOptions& options) : filename(filename), options(options) {
+        struct stat st;
+        if (stat(filename.c_str(), &st) == 0) {
+            file_bytes = st.st_size; // Appending to an earlier run's log
+            if (options.rotate_bytes > 0 && file_bytes >= options.rotate_bytes) rotate();
+        }
+        open_file();
+    }
+
+    ~LogWriter() {
+        flush_block();
+    }
+
+    bool ok() const { return (bool)out; }
+
+    void write(const std::string& line, long line_ms) {
+        if (file_start_ms < 0) file_start_ms = line_ms;
+        if ((options.rotate_bytes > 0 && file_bytes + (long)block.size() >= options.rotate_bytes) ||
+            (options.rotate_ms > 0 && line_ms - file_start_ms >= options.rotate_ms)) {
+            flush_block();
+            out.close();
+            rotate();
+            open_file();
+            file_start_ms = line_ms;
+        }
+        block += line;
+        block += '\n';
+        if (!options.compress || block.size() >= LOG_BLOCK_BYTES) flush_block();
+    }
+
+private:
+    std::string filename;
+    LogOptions options;
+    std::ofstream out;
+    std::string block;        // lines not yet written (a whole block when compressing)
+    long file_bytes = 0;
+    long file_start_ms = -1;
+
+    void open_file() {
+        out.open(filename, std::ios::out | std::ios::app | std::ios::binary);
+    }
+
+    // <log>.keep falls off the end, everything else moves up one
+    void rotate() {
+        if (options.keep < 1) {
+            remove(filename.c_str());
+        } else {
+            remove((filename + "." + std::to_string(options.keep)).c_str());
+            for (int i = options.keep - 1; i >= 1; --i) {
+                rename((filename + "." + std::to_string(i)).c_str(), (filename + "." + std::to_string(i + 1)).c_str());
+            }
+            rename(filename.c_str(), (filename + ".1").c_str());
+        }
+        file_bytes = 0;
+    }
+
+    void flush_block() {
+        if (block.empty()) return;
+        if (options.compress) {
+            // Block header: magic, raw size, compressed size (little-endian), then the payload
+            std::string payload = lz_compress(block);
+            uint32_t sizes[2] = {(uint32_t)block.size(), (uint32_t)payload.size()};
+            out.write(LOG_BLOCK_MAGIC, 4);
+            out.write((const char*)sizes, sizeof(sizes));
+            out.write(payload.data(), payload.size());
+            file_bytes += 4 + sizeof(sizes) + payload.size();
+        } else {
+            out.write(block.data(), block.size());
+            file_bytes += block.size();
+        }
+        block.clear();
+    }
+};
+
+long merge_log_segments(const std::string& filename, const LogOptions& options) {
+    size_t slash = filename.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : filename.substr(0, slash == 0 ? 1 : slash);
+    std::string prefix = (slash == std::string::npos ? filename : filename.substr(slash + 1)) + "." + options.run_id + ".";
+    std::string suffix = ".seg";
+
+    std::vector<std::string> paths;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return -1;
+    while (dirent* entry = readdir(d)) {
+        std::string name = entry->d_name;
+        if (name.size() > prefix.size() + suffix.size() && name.rfind(prefix, 0) == 0 &&
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            paths.push_back(dir + "/" + name);
+        }
+    }
+    closedir(d);
+
+    // Each segment is already in sim-time order, so a heap of one record per segment suffices
+    std::vector<std::unique_ptr<SegmentReader>> readers;
+    typedef std::pair<long, size_t> HeapEntry; // (sim time, reader)
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+    for (const std::string& path : paths) {
+        readers.emplace_back(new SegmentReader());
+        readers.back()->in.open(path);
+        if (readers.back()->next()) heap.push({readers.back()->sim_time, readers.size() - 1});
+    }
+
+    long lines = 0;
+    {
+        LogWriter writer(filename, options);
+        if (!writer.ok()) return -1;
+        while (!heap.empty()) {
+            SegmentReader& reader = *readers[heap.top().second];
+            size_t index = heap.top().second;
+            heap.pop();
+            writer.write(reader.line, reader.wall_ms);
+            lines++;
+            if (reader.next()) heap.push({reader.sim_time, index});
+        }
+    }
+    for (const std::string& path : paths) {
+        remove(path.c_str());
+    }
+    return lines;
+}
@@ -10,22 +10,50 @@
 #include <fstream>
 #include <pthread.h>
 
+// How a Logger writes. By default every line is appended to the log file as it happens. With
+// segments, each process buffers into its own segment file and merge_log_segments() later
+// interleaves them in simulation-time order.
+struct LogOptions {
+    bool segments = false;
+    std::string run_id;       // segments are <log>.<run_id>.<pid>.seg
+    bool compress = false;    // merged log written as LZ blocks (read with ./logcat)
+    long rotate_bytes = 0;    // start a new file once this many bytes are written, 0 never
+    long rotate_ms = 0;       // or once its first line is this old, 0 never
+    int keep = 5;             // rotated files kept as <log>.1 (newest) .. <log>.keep
+};
+
 class Logger {
 public:
-    Logger(const std::string& filename, int* sim_time_ptr, pthread_mutex_t* time_mutex_ptr, bool pid_tag = false);    ~Logger();
+    Logger(const std::string& filename, int* sim_time_ptr, pthread_mutex_t* time_mutex_ptr, bool pid_tag = false,
+           const LogOptions& options = LogOptions());
+    ~Logger();
 
     void log_server(const std::string& message);
     void log_train(const std::string& train_name, const std::string& message);
 
+    // Writes this process's buffered segment lines out. Also runs at exit in every process.
+    void flush();
+
 private:
     std::ofstream log_file;
     int* sim_time;
     pthread_mutex_t* time_mutex;
     bool include_pid;
+    std::string filename;
+    LogOptions options;
+    int segment_fd = -1;
+    pid_t segment_pid = -1;   // process the open segment belongs to
+    std::string buffer;       // segment lines not yet written
+    long last_flush_ms = 0;
 
     int increment_sim_time();
     std::string format_time(int seconds);
     void log(const std::string& source, const std::string& message);
+    void open_segment();
 };
 
+// Merges every segment of the run into filename in simulation-time order, compressing and
+// rotating as options say, then deletes the segments. Returns the number of lines merged or -1.
+long merge_log_segments(const std::string& filename, const LogOptions& options);
+
 #endif
@@ -0,0 +1,95 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Prints simulation logs, plain or written with --log-compress, oldest rotated file first.
+// Usage: ./logcat [simulation.log ...]        (defaults to simulation.log.N .. simulation.log)
+//        ./logcat --merge=RUN_ID [simulation.log]   merges segments a killed run left behind
+
+#include "log.h"
+#include "lz_codec.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <sys/stat.h>
+
+#define LOG_BLOCK_MAGIC "TLZB"
+
+// Writes one log file to stdout. Returns false if it is missing or a block is corrupt.
+static bool cat_log(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Error: Could not open " << path << std::endl;
+        return false;
+    }
+    char magic[4];
+    if (!in.read(magic, 4) || memcmp(magic, LOG_BLOCK_MAGIC, 4) != 0) {
+        // Plain text
+        in.clear();
+        in.seekg(0);
+        std::cout << in.rdbuf();
+        return true;
+    }
+
+    std::string payload, raw;
+    do {
+        if (memcmp(magic, LOG_BLOCK_MAGIC, 4) != 0) {
+            std::cerr << "Error: Bad block header in " << path << std::endl;
+            return false;
+        }
+        uint32_t sizes[2];
+        if (!in.read((char*)sizes, sizeof(sizes))) break;
+        payload.resize(sizes[1]);
+        if (!in.read(&payload[0], sizes[1]) || !lz_decompress(payload, sizes[0], raw)) {
+            std::cerr << "Error: Corrupt block in " << path << std::endl;
+            return false;
+        }
+        std::cout << raw;
+    } while (in.read(magic, 4));
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> paths;
+    std::string merge_run;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--merge=", 0) == 0) {
+            merge_run = arg.substr(8);
+        } else if (arg[0] == '-') {
+            std::cerr << "Usage: " << argv[0] << " [--merge=RUN_ID] [LOG...]\n";
+            return 1;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    if (!merge_run.empty()) {
+        LogOptions options;
+        options.run_id = merge_run;
+        std::string log = paths.empty() ? "simulation.log" : paths[0];
+        long lines = merge_log_segments(log, options);
+        if (lines < 0) {
+            std::cerr << "Error: Could not merge segments of run " << merge_run << std::endl;
+            return 1;
+        }
+        std::cerr << "Merged " << lines << " lines of run " << merge_run << " into " << log << std::endl;
+        return 0;
+    }
+
+    if (paths.empty()) {
+        // Rotated files first, oldest (highest number) to newest
+        struct stat st;
+        int last = 0;
+        while (stat(("simulation.log." + std::to_string(last + 1)).c_str(), &st) == 0) last++;
+        for (int i = last; i >= 1; --i) paths.push_back("simulation.log." + std::to_string(i));
+        paths.push_back("simulation.log");
+    }
+    bool ok = true;
+    for (const std::string& path : paths) {
+        ok = cat_log(path) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Implements the LZ77 log block codec with a single-probe hash table of 4-byte prefixes.
+
+#include "lz_codec.h"
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#define LZ_HASH_BITS 14
+
+static void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += (char)(value | 0x80);
+        value >>= 7;
+    }
+    out += (char)value;
+}
+
+static bool get_varint(const std::string& in, size_t& pos, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        uint8_t byte = in[pos++];
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static uint32_t read32(const std::string& in, size_t pos) {
+    uint32_t value;
+    memcpy(&value, in.data() + pos, sizeof(value));
+    return value;
+}
+
+std::string lz_compress(const std::string& in) {
+    std::string out;
+    out.reserve(in.size() / 2 + 16);
+    std::vector<int64_t> table(1 << LZ_HASH_BITS, -1);
+    size_t n = in.size();
+    size_t anchor = 0; // first byte not yet emitted
+    size_t pos = 0;
+
+    while (pos + LZ_MIN_MATCH <= n) {
+        uint32_t prefix = read32(in, pos);
+        uint32_t hash = (prefix * 2654435761u) >> (32 - LZ_HASH_BITS);
+        int64_t candidate = table[hash];
+        table[hash] = pos;
+        if (candidate < 0 || pos - candidate > LZ_MAX_OFFSET || read32(in, candidate) != prefix) {
+            pos++;
+            continue;
+        }
+
+        size_t length = LZ_MIN_MATCH;
+        while (pos + length < n && in[candidate + length] == in[pos + length]) length++;
+
+        put_varint(out, pos - anchor);
+        out.append(in, anchor, pos - anchor);
+        put_varint(out, length - LZ_MIN_MATCH);
+        uint16_t offset = pos - candidate;
+        out += (char)(offset & 0xff);
+        out += (char)(offset >> 8);
+        pos += length;
+        anchor = pos;
+    }
+
+    // The block always ends with a literal run, possibly empty
+    put_varint(out, n - anchor);
+    out.append(in, anchor, n - anchor);
+    return out;
+}
+
+bool lz_decompress(const std::string& in, size_t raw_len, std::string& out) {
+    out.clear();
+    out.reserve(raw_len);
+    size_t pos = 0;
+    while (true) {
+        uint64_t literals;
+        if (!get_varint(in, pos, literals) || literals > in.size() - pos || out.size() + literals > raw_len) {
+            return false;
+        }
+        out.append(in, pos, literals);
+        pos += literals;
+        if (pos == in.size()) break;
+
+        uint64_t length;
+        if (!get_varint(in, pos, length) || pos + 2 > in.size()) return false;
+        length += LZ_MIN_MATCH;
+        size_t offset = (uint8_t)in[pos] | ((uint8_t)in[pos + 1] << 8);
+        pos += 2;
+        if (offset == 0 || offset > out.size() || out.size() + length > raw_len) return false;
+
+        // Byte by byte: a match may overlap the bytes it is producing
+        size_t from = out.size() - offset;
+        for (size_t i = 0; i < length; ++i) out += out[from + i];
+    }
+    return out.size() == raw_len;
+}
@@ -0,0 +1,22 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Declares a small LZ77 block codec for log files, so compressed logs need no external library.
+// A block is a run of sequences: varint literal count, the literals, then (unless the block ends there)
+// varint match length - LZ_MIN_MATCH and a 16-bit little-endian offset back into the output.
+
+#ifndef LZ_CODEC_H
+#define LZ_CODEC_H
+
+#include <string>
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+
+// Compresses one block. Log lines repeat their prefixes constantly, so greedy matching is plenty.
+std::string lz_compress(const std::string& in);
+
+// Decompresses one block that must expand to exactly raw_len bytes. Returns false on corrupt input.
+bool lz_decompress(const std::string& in, size_t raw_len, std::string& out);
+
+#endif // LZ_CODEC_H
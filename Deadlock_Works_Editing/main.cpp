@@ -4,27 +4,28 @@
 // Description: Entry point for train simulation. Initializes shared memory, logging, parses input files, forks server and train processes, and coordinates simulation flow.
 
 #include <iostream>
-#include <sys/ipc.h>
-#include <sys/shm.h>
-#include <sys/msg.h>
 #include <unistd.h>
 #include <vector>
+#include <map>
+#include <algorithm>
+#include <fstream>
 #include <cstring>
+#include <cerrno>
 #include <sys/wait.h>
 #include "parser.h"
 #include "sync.h"
 #include "log.h"
 #include "detect_deadlock.h"
-
-#define SHM_KEY 12345
-#define MSGKEY 1234
-
-struct TrainMessage {
-    long type;
-    int train_id;
-    char command[10];
-    char intersection[50];
-};
+#include "components.h"
+#include "detection_policy.h"
+#include "message.h"
+#include "server.h"
+#include "stats.h"
+#include "transport.h"
+#include "checkpoint.h"
+#include "run_ipc.h"
+#include "trace.h"
+#include "placement.h"
 
 SharedMemory* shm;
 int* sim_time;
@@ -33,186 +34,677 @@ pthread_mutex_t* time_mutex;
 std::vector<std::vector<int>> allocation;
 std::vector<std::vector<int>> request;
 std::vector<int> available;
+ResourceComponents* components;
+DetectionPolicy detection_policy;
+SimStats* stats;
+std::string contention_report_path = "contention_report.txt";
+TransportConfig transport_config;
+PlacementConfig placement;
+AdmissionConfig admission;
+std::string checkpoint_path;
+long checkpoint_interval_ms = 1000;
+std::string intersections_path = "intersections.txt";
+bool watch_intersections = false;
+
+enum MovementMode {
+    MOVE_HOLD_ALL,   // acquire the whole route, then release it (the deadlock demo)
+    MOVE_HOP,        // one hop at a time: acquire, traverse, release, then ask for the next
+    MOVE_PIPELINED   // hand-over-hand: the next hop is requested while traversing the current one
+};
+MovementMode movement = MOVE_HOLD_ALL;
+long traverse_ms = 1000;
 
-void run_server(Logger& logger) {
-    int msgid = msgget(MSGKEY, IPC_CREAT | 0666);
+static void send_request(TrainTransport* transport, int train_id, const char* command,
+                         const std::string& inter, const std::string& from = "") {
     TrainMessage msg;
-
-    while (true) {
-        if (msgrcv(msgid, &msg, sizeof(msg) - sizeof(long), 1, 0) > 0) {
-            if (strcmp(msg.command, "shutdown") == 0) {
-                logger.log_server("Shutdown command received. Exiting server.");
-                break;
-            }
-
-            std::string inter = msg.intersection;
-            logger.log_server("Received request from Train" + std::to_string(msg.train_id) + ": " + msg.command);
-
-            int train_idx = msg.train_id - 1;
-            int inter_idx = find_intersection_index(inter, shm);
-
-            if (strcmp(msg.command, "acquire") == 0) {
-                request[train_idx][inter_idx] = 1;
-
-// Detect before acquiring (deadlock if both waiting)
-	std::cout << "[DEBUG] Running deadlock detection check...\n";
-bool deadlock = detect_deadlock(allocation, request, available);
-logger.log_server("Deadlock check triggered"); // Confirm logger is hit
-
-
-// Print matrix every time, not just when a deadlock is found
-std::cout << "==== DEADLOCK CHECK ====\nAllocation:\n";
-for (auto& row : allocation) {
-    for (int x : row) std::cout << x << " ";
-    std::cout << "\n";
-}
-std::cout << "Request:\n";
-for (auto& row : request) {
-    for (int x : row) std::cout << x << " ";
-    std::cout << "\n";
+    memset(&msg, 0, sizeof(msg));
+    msg.type = REQUEST_TYPE;
+    msg.train_id = train_id;
+    strncpy(msg.command, command, sizeof(msg.command) - 1);
+    strncpy(msg.intersection, inter.c_str(), sizeof(msg.intersection) - 1);
+    strncpy(msg.from, from.c_str(), sizeof(msg.from) - 1);
+    transport->send(msg);
 }
-std::cout << "Available:\n";
-for (int x : available) std::cout << x << " ";
-std::cout << "\n========================\n";
-
-if (deadlock) {
-    logger.log_server("Deadlock detected.");
-    recover_from_deadlock(allocation, request, available, shm, logger);
-    continue;
+
+// Blocks for the answer to the acquire for inter. BUSY means the server did not admit it, so the
+// acquire goes out again after the server's hint plus an exponential backoff with jitter; always
+// as a plain acquire, since the release half of an ADVANCE was applied either way.
+static bool receive_answer(TrainTransport* transport, int train_id, const std::string& inter, TrainMessage& msg,
+                           Logger& logger, TrainStats* my_stats) {
+    std::string name = "TRAIN" + std::to_string(train_id);
+    for (int attempt = 0;; ++attempt) {
+        bool received = transport->receive(train_id, msg);
+        if (my_stats) stat_set(my_stats->send_retries, transport->full_retries());
+        if (!received) return false;
+        if (strcmp(msg.command, "busy") != 0) return true;
+
+        long delay = backoff_ms(attempt, msg.retry_after_ms);
+        if (my_stats) stat_add(my_stats->busy);
+        logger.log_train(name, "Busy for " + inter + ", retrying in " + std::to_string(delay) + " ms");
+        usleep(delay * 1000);
+        send_request(transport, train_id, "acquire", inter);
+        if (my_stats) stat_add(my_stats->requests); // the busy reply answered the last one
+        transport->flush();
+    }
 }
 
-                handle_acquire_request(msg.train_id, inter, shm, request);
-                request[train_idx][inter_idx] = 0;
-                allocation[train_idx][inter_idx] = 1;
-		available[inter_idx]--;
-            } else if (strcmp(msg.command, "release") == 0) {
-                handle_release_request(msg.train_id, inter, shm);
-                allocation[train_idx][inter_idx] = 0;
-                available[inter_idx]++;
-		if (detect_deadlock(allocation, request, available)) {
-        logger.log_server("Deadlock detected (post-acquire).");
-        std::cout << "==== POST-DEADLOCK CHECK ====\n";
-	recover_from_deadlock(allocation, request, available, shm, logger);
-    	continue;
-            }
-	}
-            msg.type = 2;
-            strcpy(msg.command, "granted");
-            msgsnd(msgid, &msg, sizeof(msg) - sizeof(long), 0);
-            logger.log_server("Granted " + inter + " to Train" + std::to_string(msg.train_id));
+// Moves hop by hop, holding only the intersection being traversed. In MOVE_PIPELINED the
+// request for hop i+1 goes out as the train enters hop i, and leaving hop i is one ADVANCE
+// (release hop i, acquire hop i+2), so each grant round trip overlaps a traversal instead of
+// following it. Returns false if the train was aborted as a deadlock victim.
+static bool move_hop_by_hop(int train_id, const TrainRoute& route, Logger& logger,
+                            TrainTransport* transport, TrainStats* my_stats) {
+    std::string name = "TRAIN" + std::to_string(train_id);
+    const std::vector<std::string>& hops = route.route;
+    bool prefetch = movement == MOVE_PIPELINED;
+    std::string current;       // intersection being traversed, "" before the first hop
+    bool requested = false;    // ACQUIRE for hops[i] already sent
+
+    for (size_t i = 0; i < hops.size();) {
+        if (!requested) {
+            if (!current.empty()) {
+                send_request(transport, train_id, "release", current);
+                logger.log_train(name, "Sent RELEASE for " + current);
+                current.clear();
+            }
+            send_request(transport, train_id, "acquire", hops[i]);
+            logger.log_train(name, "Sent ACQUIRE for " + hops[i]);
+            if (my_stats) stat_add(my_stats->requests);
+        }
+
+        // With prefetch the reply has usually arrived during the traversal and this does not block
+        long wait_start = stats_now_ms();
+        if (my_stats) stat_set(my_stats->state, TRAIN_WAITING);
+        TrainMessage msg;
+        if (!receive_answer(transport, train_id, hops[i], msg, logger, my_stats)) {
+            std::cerr << "Error: " << name << " lost its connection to the server\n";
+            exit(1);
+        }
+        if (my_stats) stat_add(my_stats->wait_ms, stats_now_ms() - wait_start);
+
+        if (strcmp(msg.command, "abort") == 0) {
+            logger.log_train(name, "Preempted while waiting for " + hops[i] + ", restarting route");
+            if (!current.empty()) send_request(transport, train_id, "release", current); // other shards
+            transport->flush();
+            if (my_stats) stat_add(my_stats->restarts);
+            return false;
         }
+        if (strcmp(msg.command, "denied") == 0) {
+            logger.log_train(name, "Denied " + hops[i] + ", skipping");
+            requested = false;
+            i++;
+            continue;
+        }
+        logger.log_train(name, "Granted " + hops[i]);
+        if (my_stats) stat_add(my_stats->grants);
+
+        // Leave the current hop and, when prefetching, ask for the one after next in the same message
+        bool ask_next = prefetch && i + 1 < hops.size();
+        if (!current.empty() && ask_next &&
+            shard_of(current, transport_config.num_shards) == shard_of(hops[i + 1], transport_config.num_shards)) {
+            send_request(transport, train_id, "advance", hops[i + 1], current);
+            logger.log_train(name, "Sent ADVANCE " + current + " -> " + hops[i + 1]);
+        } else {
+            if (!current.empty()) {
+                send_request(transport, train_id, "release", current);
+                logger.log_train(name, "Sent RELEASE for " + current);
+            }
+            if (ask_next) {
+                send_request(transport, train_id, "acquire", hops[i + 1]);
+                logger.log_train(name, "Sent ACQUIRE for " + hops[i + 1]);
+            }
+        }
+        if (ask_next && my_stats) stat_add(my_stats->requests);
+        requested = ask_next;
+        current = hops[i];
+        i++;
+
+        transport->flush();
+        if (my_stats) stat_set(my_stats->state, TRAIN_TRAVERSING);
+        usleep(traverse_ms * 1000);
+    }
+
+    if (!current.empty()) {
+        send_request(transport, train_id, "release", current);
+        logger.log_train(name, "Sent RELEASE for " + current);
     }
+    transport->flush();
+    return true;
 }
 
-void run_train(int train_id, const TrainRoute& route, Logger& logger) {
+// resume, if given, is where the checkpoint left this train: it already holds resume->held
+// and continues from hop resume->route_pos instead of the start of its route
+void run_train(int train_id, const TrainRoute& route, Logger& logger, const TrainCheckpoint* resume) {
     sleep(1); // For deadlock
-    int msgid = msgget(MSGKEY, 0666);
+    TrainTransport* transport = open_train_transport(transport_config);
     TrainMessage msg;
-    msg.train_id = train_id;
-    msg.type = 1;
-    
-    // Acquire all intersections first
-    for (size_t i = 0; i < route.route.size(); ++i) {
-    const std::string& inter = route.route[i];
+    std::string name = "TRAIN" + std::to_string(train_id);
+    TrainStats* my_stats = (stats && train_id <= MAX_STAT_TRAINS) ? &stats->trains[train_id - 1] : nullptr;
+
+    bool completed = false;
+    if (movement != MOVE_HOLD_ALL) {
+        while (!move_hop_by_hop(train_id, route, logger, transport, my_stats)) {
+            sleep(1);
+        }
+        completed = true;
+    }
+    while (!completed) {
+        std::vector<std::string> held;
+        bool preempted = false;
+        size_t start = 0;
+        bool still_queued = false;
+        if (resume) {
+            for (int r : resume->held) held.push_back(shm->intersections[r].name);
+            start = resume->route_pos;
+            still_queued = resume->waiting_on != -1;
+            logger.log_train(name, "Resuming at hop " + std::to_string(start) + " holding " + std::to_string(held.size()));
+            resume = nullptr;
+        }
 
-    strcpy(msg.command, "acquire");
-    strncpy(msg.intersection, inter.c_str(), sizeof(msg.intersection));
-    msgsnd(msgid, &msg, sizeof(msg) - sizeof(long), 0);
-    logger.log_train("TRAIN" + std::to_string(train_id), "Sent ACQUIRE for " + inter);
+        // Acquire all intersections first
+        for (size_t i = start; i < route.route.size(); ++i) {
+            const std::string& inter = route.route[i];
 
-    msgrcv(msgid, &msg, sizeof(msg) - sizeof(long), 2, 0);
-    logger.log_train("TRAIN" + std::to_string(train_id), "Granted " + inter);
+            const char* command = still_queued ? "resume" : "acquire";
+            still_queued = false;
+            long sent_ms = stats_now_ms();
+            if (my_stats) {
+                stat_set(my_stats->state, TRAIN_WAITING);
+                stat_add(my_stats->requests);
+            }
+            send_request(transport, train_id, command, inter);
+            logger.log_train(name, "Sent ACQUIRE for " + inter);
 
-    if (i == 0) sleep(1);
-}
+            if (!receive_answer(transport, train_id, inter, msg, logger, my_stats)) {
+                std::cerr << "Error: " << name << " lost its connection to the server\n";
+                exit(1);
+            }
+            if (my_stats) {
+                stat_add(my_stats->wait_ms, stats_now_ms() - sent_ms);
+                stat_set(my_stats->state, TRAIN_TRAVERSING);
+            }
+            if (strcmp(msg.command, "abort") == 0) {
+                // Chosen as a deadlock victim: the server already took back everything we held on its
+                // shard, the releases below free what we hold on the others (and are ignored otherwise)
+                logger.log_train(name, "Preempted while waiting for " + inter + ", restarting route");
+                for (const std::string& held_inter : held) {
+                    send_request(transport, train_id, "release", held_inter);
+                }
+                transport->flush();
+                if (my_stats) stat_add(my_stats->restarts);
+                preempted = true;
+                break;
+            }
+            if (strcmp(msg.command, "denied") == 0) {
+                logger.log_train(name, "Denied " + inter + ", skipping");
+                continue;
+            }
+            logger.log_train(name, "Granted " + inter);
+            if (my_stats) stat_add(my_stats->grants);
+            held.push_back(inter);
+
+            if (i == 0) sleep(1);
+        }
 
-    // Then release all intersections
-    for (const std::string& inter : route.route) {
-        strcpy(msg.command, "release");
-        strncpy(msg.intersection, inter.c_str(), sizeof(msg.intersection));
-        msgsnd(msgid, &msg, sizeof(msg) - sizeof(long), 0);
-        logger.log_train("TRAIN" + std::to_string(train_id), "Sent RELEASE for " + inter);
+        if (preempted) {
+            sleep(1);
+            continue;
+        }
+
+        // Then release all intersections
+        for (const std::string& inter : held) {
+            send_request(transport, train_id, "release", inter);
+            logger.log_train(name, "Sent RELEASE for " + inter);
+        }
+        transport->flush();
+        completed = true;
     }
 
-    logger.log_train("TRAIN" + std::to_string(train_id), "Completed route.");
+    delete transport;
+
+    logger.log_train(name, "Completed route.");
+    if (my_stats) stat_set(my_stats->state, TRAIN_DONE);
     exit(0);
 }
 
 
-void init_shared_memory() {
-    int shmid = shmget(SHM_KEY, sizeof(SharedMemory), IPC_CREAT | 0666);
-    shm = (SharedMemory*)shmat(shmid, nullptr, 0);
-    new (shm) SharedMemory();
+// Applies --numa to a segment. A refused policy only costs locality, so the run goes on.
+void place_segment(const char* what, void* addr, size_t size) {
+    if (!place_memory(addr, size, placement)) {
+        std::cerr << "Warning: Could not apply NUMA policy " << describe_numa(placement) << " to the " << what
+                  << " segment: " << strerror(errno) << "\n";
+    }
+}
 
-    int time_shmid = shmget(0x1234, sizeof(int), IPC_CREAT | 0666);
-    sim_time = (int*)shmat(time_shmid, nullptr, 0);
+// Segments are named after the run ID, so simulations on the same host never share them
+bool init_shared_memory(const std::string& run_id) {
+    shm = (SharedMemory*)create_segment(run_id, "intersections", sizeof(SharedMemory));
+    sim_time = (int*)create_segment(run_id, "time", sizeof(int));
+    time_mutex = (pthread_mutex_t*)create_segment(run_id, "time_mutex", sizeof(pthread_mutex_t));
+    if (!shm || !sim_time || !time_mutex) {
+        return false;
+    }
+    // Before the first write below, which would otherwise put every page on this process's node
+    place_segment("intersections", shm, sizeof(SharedMemory));
+    place_segment("time", sim_time, sizeof(int));
+    place_segment("time_mutex", time_mutex, sizeof(pthread_mutex_t));
+    new (shm) SharedMemory();
     *sim_time = 0;
 
-    int mutex_shmid = shmget(0x5678, sizeof(pthread_mutex_t), IPC_CREAT | 0666);
-    time_mutex = (pthread_mutex_t*)shmat(mutex_shmid, nullptr, 0);
-
     pthread_mutexattr_t attr;
     pthread_mutexattr_init(&attr);
     pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
     pthread_mutex_init(time_mutex, &attr);
     pthread_mutexattr_destroy(&attr);
+    return true;
 }
 
 void populate_intersections(const std::unordered_map<std::string, Intersection>& parsed) {
     int idx = 0;
+    pthread_mutex_lock(&shm->shared_memory_mutex);
+    table_write_begin(shm);
     for (const auto& [name, inter] : parsed) {
         strncpy(shm->intersections[idx].name, name.c_str(), MAX_INTERSECTION_NAME_LENGTH);
         shm->intersections[idx].capacity = inter.capacity;
         shm->intersections[idx].lock_type = inter.isMutex ? 1 : inter.capacity;
-        sem_init(&shm->intersections[idx].semaphore, 1, inter.capacity);
+        ticket_init(&shm->semaphores[idx], inter.capacity);
         ++idx;
 	std::cout << "[DEBUG] Initialized " << name << " with capacity " << inter.capacity << std::endl;
 
     }
+    table_write_end(shm);
+    pthread_mutex_unlock(&shm->shared_memory_mutex);
 }
 
 void init_matrices(int num_trains, int num_resources) {
     allocation.assign(num_trains, std::vector<int>(num_resources, 0));
     request.assign(num_trains, std::vector<int>(num_resources, 0));
-    available.assign(num_resources, 1);
+    available.assign(num_resources, 0);
+    for (int j = 0; j < num_resources; ++j) {
+        available[j] = shm->intersections[j].capacity;
+    }
+    components = new ResourceComponents(num_trains, num_resources);
+}
+
+// One key=value per line, read back by the sweep runner
+bool write_metrics(const std::string& path, const std::string& run_id, long makespan_ms, int num_trains, int trains_failed) {
+    std::ofstream out(path);
+    if (!out) return false;
+    long grants = stats ? stats->grants.load() : 0;
+    long send_retries = 0;
+    for (int t = 0; stats && t < num_trains && t < MAX_STAT_TRAINS; ++t) send_retries += stats->trains[t].send_retries.load();
+    out << "run_id=" << run_id << "\n"
+        << "trains=" << num_trains << "\n"
+        << "trains_failed=" << trains_failed << "\n"
+        << "makespan_ms=" << makespan_ms << "\n"
+        << "sim_time=" << *sim_time << "\n"
+        << "requests=" << (stats ? stats->requests.load() : 0) << "\n"
+        << "grants=" << grants << "\n"
+        << "grants_per_sec=" << (makespan_ms > 0 ? grants * 1000.0 / makespan_ms : 0.0) << "\n"
+        << "waits=" << (stats ? stats->waits.load() : 0) << "\n"
+        << "deadlocks=" << (stats ? stats->deadlocks.load() : 0) << "\n"
+        << "recoveries=" << (stats ? stats->recoveries.load() : 0) << "\n"
+        << "p99_wait_us=" << (stats ? stats->p99_wait_us.load() : 0) << "\n"
+        << "busy=" << (stats ? stats->busy.load() : 0) << "\n"
+        << "send_retries=" << send_retries << "\n"
+        << "max_queue_depth=" << (stats ? stats->max_queue_depth.load() : 0) << "\n"
+        << "server_cpus=" << describe_cpus(placement.server_cpus) << "\n"
+        << "train_cpus=" << describe_cpus(placement.train_cpus) << "\n"
+        << "numa=" << describe_numa(placement) << "\n";
+    return (bool)out;
+}
+
+// Called in the shard's own process, so threads it starts later inherit the mask
+void pin_server(Logger& logger, int shard) {
+    int cpu = server_cpu(placement, shard);
+    if (cpu < 0) return;
+    if (pin_to_cpu(cpu)) {
+        logger.log_server("Shard " + std::to_string(shard) + " pinned to CPU " + std::to_string(cpu));
+    } else {
+        std::cerr << "Warning: Could not pin shard " << shard << " to CPU " << cpu << ": " << strerror(errno) << "\n";
+    }
+}
+
+// Every other process of the run has exited by now, so their segments are complete
+void finish_log(Logger& logger, const LogOptions& options) {
+    if (!options.segments) return;
+    logger.flush();
+    if (merge_log_segments("simulation.log", options) < 0) {
+        std::cerr << "Error: Could not merge the log segments into simulation.log\n";
+    }
 }
 
-int main() {
-    init_shared_memory();
-    Logger logger("simulation.log", sim_time, time_mutex, true);
+int main(int argc, char* argv[]) {
+    std::string role = "all";
+    int only_shard = 0;
+    std::string resume_path;
+    std::string requested_run_id;
+    std::string trains_path = "trains.txt";
+    std::string metrics_path;
+    std::string schedule_path;
+    std::string trace_path;
+    LogOptions log_options;
+    log_options.segments = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--detect=", 0) == 0) {
+            if (!parse_detection_policy(arg.substr(9), detection_policy)) {
+                std::cerr << "Error: Bad detection policy " << arg.substr(9)
+                          << " (use request, count:N, wall:MS, virtual:TICKS or wait:MS)\n";
+                return 1;
+            }
+        } else if (arg.rfind("--detect-threads=", 0) == 0) {
+            detection_policy.threads = atoi(arg.c_str() + 17);
+            if (detection_policy.threads < 1) detection_policy.threads = 1;
+        } else if (arg.rfind("--contention-report=", 0) == 0) {
+            contention_report_path = arg.substr(20);
+        } else if (arg.rfind("--checkpoint=", 0) == 0) {
+            checkpoint_path = arg.substr(13);
+        } else if (arg.rfind("--checkpoint-interval=", 0) == 0) {
+            checkpoint_interval_ms = atol(arg.c_str() + 22);
+            if (checkpoint_interval_ms < 1) checkpoint_interval_ms = 1;
+        } else if (arg.rfind("--resume=", 0) == 0) {
+            resume_path = arg.substr(9);
+        } else if (arg.rfind("--intersections=", 0) == 0) {
+            intersections_path = arg.substr(16);
+        } else if (arg == "--watch-intersections") {
+            watch_intersections = true;
+        } else if (arg.rfind("--trains=", 0) == 0) {
+            trains_path = arg.substr(9);
+        } else if (arg.rfind("--schedule=", 0) == 0) {
+            schedule_path = arg.substr(11);
+        } else if (arg.rfind("--metrics=", 0) == 0) {
+            metrics_path = arg.substr(10);
+        } else if (arg.rfind("--movement=", 0) == 0) {
+            std::string mode = arg.substr(11);
+            if (mode == "hold-all") movement = MOVE_HOLD_ALL;
+            else if (mode == "hop") movement = MOVE_HOP;
+            else if (mode == "pipelined") movement = MOVE_PIPELINED;
+            else {
+                std::cerr << "Error: Bad movement " << mode << " (use hold-all, hop or pipelined)\n";
+                return 1;
+            }
+        } else if (arg.rfind("--traverse-ms=", 0) == 0) {
+            traverse_ms = atol(arg.c_str() + 14);
+            if (traverse_ms < 0) traverse_ms = 0;
+        } else if (arg == "--log-direct") {
+            log_options.segments = false;
+        } else if (arg == "--log-compress") {
+            log_options.compress = true;
+        } else if (arg.rfind("--log-rotate-bytes=", 0) == 0) {
+            log_options.rotate_bytes = atol(arg.c_str() + 19);
+        } else if (arg.rfind("--log-rotate-ms=", 0) == 0) {
+            log_options.rotate_ms = atol(arg.c_str() + 16);
+        } else if (arg.rfind("--log-keep=", 0) == 0) {
+            log_options.keep = atoi(arg.c_str() + 11);
+        } else if (arg.rfind("--trace=", 0) == 0) {
+            trace_path = arg.substr(8);
+        } else if (arg.rfind("--run-id=", 0) == 0) {
+            requested_run_id = arg.substr(9);
+        } else if (arg.rfind("--transport=", 0) == 0) {
+            if (!parse_transport(arg.substr(12), transport_config)) {
+                std::cerr << "Error: Bad transport " << arg.substr(12) << " (use msgq, tcp:HOST:PORT or unix:PATH)\n";
+                return 1;
+            }
+        } else if (arg.rfind("--shards=", 0) == 0) {
+            transport_config.num_shards = atoi(arg.c_str() + 9);
+        } else if (arg.rfind("--server-cpus=", 0) == 0) {
+            if (!parse_cpu_list(arg.substr(14), placement.server_cpus)) {
+                std::cerr << "Error: Bad CPU list " << arg.substr(14) << " (use e.g. 0-3,8)\n";
+                return 1;
+            }
+        } else if (arg.rfind("--train-cpus=", 0) == 0) {
+            if (!parse_cpu_list(arg.substr(13), placement.train_cpus)) {
+                std::cerr << "Error: Bad CPU list " << arg.substr(13) << " (use e.g. 0-3,8)\n";
+                return 1;
+            }
+        } else if (arg.rfind("--numa=", 0) == 0) {
+            if (!parse_numa_policy(arg.substr(7), placement)) {
+                std::cerr << "Error: Bad NUMA policy " << arg.substr(7) << " (use local, bind:NODES or interleave:NODES)\n";
+                return 1;
+            }
+        } else if (arg.rfind("--max-inflight=", 0) == 0) {
+            admission.max_inflight = atoi(arg.c_str() + 15);
+        } else if (arg.rfind("--max-train-inflight=", 0) == 0) {
+            admission.max_train_inflight = atoi(arg.c_str() + 21);
+        } else if (arg.rfind("--busy-retry-ms=", 0) == 0) {
+            admission.retry_after_ms = atoi(arg.c_str() + 16);
+        } else if (arg.rfind("--role=", 0) == 0) {
+            role = arg.substr(7);
+        } else if (arg.rfind("--shard=", 0) == 0) {
+            only_shard = atoi(arg.c_str() + 8);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--detect=request|count:N|wall:MS|virtual:TICKS|wait:MS] [--detect-threads=N] [--contention-report=PATH]\n"
+                      << "       [--transport=msgq|tcp:HOST:PORT|unix:PATH] [--shards=K] [--role=all|server|trains|reload] [--shard=I]\n"
+                      << "       [--checkpoint=PATH] [--checkpoint-interval=MS] [--resume=PATH] [--run-id=ID]\n"
+                      << "       [--intersections=PATH] [--watch-intersections] [--trains=PATH] [--metrics=PATH] [--schedule=PATH]\n"
+                      << "       [--movement=hold-all|hop|pipelined] [--traverse-ms=MS]\n"
+                      << "       [--max-inflight=N] [--max-train-inflight=N] [--busy-retry-ms=MS]\n"
+                      << "       [--log-direct] [--log-compress] [--log-rotate-bytes=N] [--log-rotate-ms=MS] [--log-keep=N]\n"
+                      << "       [--trace=PATH] [--server-cpus=LIST] [--train-cpus=LIST] [--numa=local|bind:NODES|interleave:NODES]\n";
+            return 1;
+        }
+    }
+
+    if (admission.max_inflight < 0 || admission.max_train_inflight < 0 || admission.retry_after_ms < 0) {
+        std::cerr << "Error: Admission budgets and --busy-retry-ms cannot be negative\n";
+        return 1;
+    }
+    if (role != "all" && role != "server" && role != "trains" && role != "reload") {
+        std::cerr << "Error: Bad role " << role << " (use all, server, trains or reload)\n";
+        return 1;
+    }
+    if (transport_config.num_shards < 1 || only_shard < 0 || only_shard >= transport_config.num_shards) {
+        std::cerr << "Error: Need --shards >= 1 and 0 <= --shard < --shards\n";
+        return 1;
+    }
+    if (transport_config.kind == TRANSPORT_MSGQUEUE && (transport_config.num_shards > 1 || role != "all")) {
+        std::cerr << "Error: Shards and split roles need a socket transport (tcp:HOST:PORT or unix:PATH)\n";
+        return 1;
+    }
+    if (!log_options.segments && (log_options.compress || log_options.rotate_bytes > 0 || log_options.rotate_ms > 0)) {
+        // Compression and rotation happen while merging, which --log-direct skips
+        std::cerr << "Error: --log-compress and --log-rotate-* need segment logging (drop --log-direct)\n";
+        return 1;
+    }
+    if ((!checkpoint_path.empty() || !resume_path.empty()) && movement != MOVE_HOLD_ALL) {
+        // A checkpoint records a held prefix of the route, which only hold-all movement has
+        std::cerr << "Error: Checkpoints need --movement=hold-all\n";
+        return 1;
+    }
+    if ((!checkpoint_path.empty() || !resume_path.empty()) && transport_config.num_shards > 1) {
+        // Route positions are counted by the server, which only sees one shard's hops
+        std::cerr << "Error: Checkpoints need a single shard\n";
+        return 1;
+    }
+
+    std::string placement_error;
+    if (!check_placement(placement, placement_error)) {
+        std::cerr << "Error: " << placement_error << "\n";
+        return 1;
+    }
+
+    if (role == "reload") {
+        // Asks the running servers to re-read their intersections file, then exits
+        TrainTransport* control = open_train_transport(transport_config);
+        control->send_control("reload");
+        delete control;
+        return 0;
+    }
+
+    int stale = remove_stale_segments();
+    std::string run_id = init_run_id(requested_run_id);
+    install_run_cleanup();
+    if (!init_shared_memory(run_id)) {
+        std::cerr << "Error: Could not create shared memory for run " << run_id << "\n";
+        return 1;
+    }
+    log_options.run_id = run_id;
+    Logger logger("simulation.log", sim_time, time_mutex, true, log_options);
+    logger.log_server("Run ID " + run_id + (stale ? ", removed " + std::to_string(stale) + " stale segments" : ""));
+    logger.log_server("Placement: server CPUs " + describe_cpus(placement.server_cpus) + ", train CPUs " +
+                      describe_cpus(placement.train_cpus) + ", NUMA " + describe_numa(placement));
     
-    auto intersections = parseIntersections("intersections.txt");
-    auto trains = parseTrains("trains.txt");
+    auto intersections = parseIntersections(intersections_path);
+    auto trains = parseTrains(trains_path);
 
     if (intersections.empty() || trains.empty()) {
         std::cerr << "Error: Failed to parse input files.\n";
         return 1;
     }
+    std::unordered_map<std::string, ScheduleEntry> schedule;
+    if (!schedule_path.empty()) {
+        schedule = parseSchedule(schedule_path);
+        if (schedule.empty()) {
+            std::cerr << "Error: Failed to parse schedule " << schedule_path << "\n";
+            return 1;
+        }
+    }
 
     logger.log_server("Initialized intersections");
     populate_intersections(intersections);
     init_matrices(trains.size(), intersections.size());
+    stats = create_stats(run_id, shm, intersections.size(), trains.size());
+    if (stats) place_segment("stats", stats, sizeof(SimStats));
+
+    Checkpoint resume;
+    if (!resume_path.empty()) {
+        if (!load_checkpoint(resume_path, resume)) {
+            std::cerr << "Error: Could not read checkpoint " << resume_path << "\n";
+            return 1;
+        }
+        if (!checkpoint_matches(resume, shm, intersections.size(), trains.size())) {
+            std::cerr << "Error: Checkpoint " << resume_path << " was taken with different input files\n";
+            return 1;
+        }
+        *sim_time = resume.sim_time;
+        logger.log_server("Resuming from checkpoint " + std::to_string(resume.sequence));
+    }
+    const Checkpoint* resume_from = resume_path.empty() ? nullptr : &resume;
+    if (transport_config.kind == TRANSPORT_MSGQUEUE) {
+        // Private to this run; the server and trains inherit the id across fork
+        transport_config.msgid = create_run_queue();
+        if (transport_config.msgid == -1) return 1;
+    }
+
+    // Only servers write trace events, and the shards of one host share the file
+    if (!trace_path.empty() && (role == "all" || role == "server") && !trace_open(trace_path)) {
+        return 1;
+    }
+
+    if (role == "server") {
+        // This node runs one shard in the foreground; trains connect from elsewhere
+        pin_server(logger, only_shard);
+        run_server(logger, transport_config, only_shard, resume_from);
+        trace_close();
+        finish_log(logger, log_options);
+        return 0;
+    }
+
+    std::vector<pid_t> server_pids;
+    if (role == "all") {
+        for (int s = 0; s < transport_config.num_shards; ++s) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                pin_server(logger, s);
+                run_server(logger, transport_config, s, resume_from);
+                exit(0);
+            }
+            server_pids.push_back(pid);
+        }
+    }
 
-    pid_t server_pid = fork();
-    if (server_pid == 0) {
-        run_server(logger);
-        exit(0);
+    // Without a schedule every train starts at once. With one, a train starts as soon as every
+    // train the planner put before it has finished.
+    std::vector<std::vector<int>> after(trains.size());
+    if (!schedule.empty()) {
+        std::unordered_map<std::string, int> train_index;
+        for (int i = 0; i < trains.size(); ++i) train_index[trains[i].trainName] = i;
+        for (int i = 0; i < trains.size(); ++i) {
+            auto entry = schedule.find(trains[i].trainName);
+            if (entry == schedule.end()) {
+                std::cerr << "Warning: " << trains[i].trainName << " is not in the schedule, starting it at once\n";
+                continue;
+            }
+            for (const std::string& name : entry->second.after) {
+                if (train_index.count(name)) after[i].push_back(train_index[name]);
+            }
+        }
     }
 
-    for (int i = 0; i < trains.size(); ++i) {
-        pid_t pid = fork();
-        if (pid == 0) {
-            run_train(i + 1, trains[i], logger);
+    long trains_start_ms = stats_now_ms();
+    std::vector<bool> finished(trains.size(), false);
+    std::vector<bool> launched(trains.size(), false);
+    std::map<pid_t, int> running;
+    int trains_failed = 0;
+    while (true) {
+        for (int i = 0; i < trains.size(); ++i) {
+            if (launched[i]) continue;
+            bool ready = true;
+            for (int before : after[i]) ready = ready && finished[before];
+            if (!ready) continue;
+
+            launched[i] = true;
+            const TrainCheckpoint* train_resume = resume_from ? &resume.trains[i] : nullptr;
+            if (train_resume && train_resume->done) {
+                logger.log_server("Train" + std::to_string(i + 1) + " had already completed its route");
+                finished[i] = true;
+                i = -1; // Trains waiting on it may be ready now
+                continue;
+            }
+            if (!schedule.empty()) {
+                logger.log_server("Dispatching " + trains[i].trainName + " (wave " +
+                                  std::to_string(schedule[trains[i].trainName].wave) + ")");
+            }
+            pid_t pid = fork();
+            if (pid == 0) {
+                int cpu = train_cpu(placement, i + 1);
+                if (cpu >= 0 && !pin_to_cpu(cpu)) {
+                    std::cerr << "Warning: Could not pin " << trains[i].trainName << " to CPU " << cpu << "\n";
+                }
+                run_train(i + 1, trains[i], logger, train_resume);
+            }
+            running[pid] = i;
         }
+
+        if (running.empty()) {
+            int stuck = std::count(launched.begin(), launched.end(), false);
+            if (stuck == 0) break;
+            // Only a cyclic schedule gets here: start the rest rather than hang
+            std::cerr << "Warning: Schedule has a cycle, starting " << stuck << " trains at once\n";
+            for (auto& deps : after) deps.clear();
+            continue;
+        }
+
+        // Let every train finish its route before stopping the server
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        auto it = running.find(pid);
+        if (it == running.end()) {
+            if (pid > 0) {
+                std::cerr << "Error: Server process " << pid << " exited early\n";
+                server_pids.erase(std::remove(server_pids.begin(), server_pids.end(), pid), server_pids.end());
+            }
+            continue;
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) trains_failed++;
+        finished[it->second] = true;
+        running.erase(it);
     }
+    long makespan_ms = stats_now_ms() - trains_start_ms;
 
-    sleep(1);
-TrainMessage shutdown_msg = {1, 0, "shutdown", ""};
-int msgid = msgget(MSGKEY, 0666);
-msgsnd(msgid, &shutdown_msg, sizeof(shutdown_msg) - sizeof(long), 0);
+    TrainTransport* control = open_train_transport(transport_config);
+    control->send_control("shutdown");
+    delete control;
+    for (pid_t pid : server_pids) {
+        waitpid(pid, nullptr, 0);
+    }
+    trace_close();
 
-    sleep(1);
+    if (!metrics_path.empty() && !write_metrics(metrics_path, run_id, makespan_ms, trains.size(), trains_failed)) {
+        std::cerr << "Error: Could not write metrics " << metrics_path << "\n";
+    }
     logger.log_server("Simulation complete.");
-    sleep(2);
-    return 0;
-}
\ No newline at end of file
+    finish_log(logger, log_options);
+    return trains_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+// Group : I
+// Author: Wyatt Probst
+// Date: 10/19/2026
+// Description: Declares the train <-> server message format shared by the server and train processes.
+
+#ifndef MESSAGE_H
+#define MESSAGE_H
+
+#define MSGKEY 1234
+
+// Requests from trains are always type 1. Each reply is addressed to one train
+// (type = train_id + 1) so a train can never pick up a grant meant for another.
+#define REQUEST_TYPE 1
+#define REPLY_TYPE(train_id) ((long)(train_id) + 1)
+
+struct TrainMessage {
+    long type;
+    int train_id;
+    char command[10];     // acquire, release, advance, resume, shutdown / granted, denied, abort, busy
+    char intersection[50];
+    char from[50];        // advance only: released before intersection is acquired
+    int retry_after_ms;   // busy only: the earliest the acquire is worth sending again
+};
+
+#define MSG_SIZE (sizeof(TrainMessage) - sizeof(long))
+
+#endif // MESSAGE_H
@@ -80,4 +80,47 @@ std::vector<TrainRoute> parseTrains(const std::string& filename) {
 
     file.close();
     return trainRoutes;
-}
\ No newline at end of file
+}
+// parses the planner's schedule file, # starts a comment
+std::unordered_map<std::string, ScheduleEntry> parseSchedule(const std::string& filename) {
+    std::unordered_map<std::string, ScheduleEntry> schedule;
+    std::ifstream file(filename);
+    std::string line;
+
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open " << filename << std::endl;
+        return schedule;
+    }
+
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        line.erase(std::remove_if(line.begin(), line.end(), isspace), line.end());
+        if (line.empty()) continue;
+
+        size_t colonPos = line.find(':');
+        if (colonPos == std::string::npos) {
+            std::cerr << "Warning: Skipping invalid line: " << line << std::endl;
+            continue;
+        }
+        size_t afterPos = line.find(':', colonPos + 1);
+
+        ScheduleEntry entry;
+        try {
+            entry.wave = std::stoi(line.substr(colonPos + 1, afterPos - colonPos - 1));
+        } catch (...) {
+            std::cerr << "Could not parse wave in line: " << line << std::endl;
+            continue;
+        }
+        if (afterPos != std::string::npos) {
+            std::istringstream ss(line.substr(afterPos + 1));
+            std::string train;
+            while (std::getline(ss, train, ',')) {
+                if (!train.empty()) entry.after.push_back(train);
+            }
+        }
+        schedule[line.substr(0, colonPos)] = entry;
+    }
+
+    file.close();
+    return schedule;
+}
@@ -30,4 +30,13 @@ std::unordered_map<std::string, Intersection> parseIntersections(const std::stri
 //parsing the trans.txt and returns a vector of TrainRoute structs
 std::vector<TrainRoute> parseTrains(const std::string&filename);
 
+//dispatch slot for one train, written by the planner
+struct ScheduleEntry {
+    int wave;
+    std::vector<std::string> after; //trains that must finish before this one starts
+};
+
+//parse schedule.txt (Train1:wave[:TrainA,TrainB]) into a map of train name to ScheduleEntry
+std::unordered_map<std::string, ScheduleEntry> parseSchedule(const std::string& filename);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,144 @@
+// Group : I
+// Author: Samuel Shankle
+// Email: samuel.shankle@okstate.edu
+// Date: 10/19/2026
+// Description: Implements CPU pinning with sched_setaffinity and NUMA placement with the mbind system call, called
+// directly so the simulator does not need libnuma.
+
+#include "placement.h"
+#include <sstream>
+#include <cerrno>
+#include <cstdlib>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+// From <linux/mempolicy.h>
+#define MPOL_BIND_MODE 2
+#define MPOL_INTERLEAVE_MODE 3
+#define MPOL_LOCAL_MODE 4
+#define MPOL_MF_MOVE_FLAG (1 << 1)
+
+#define MAX_NUMA_NODES 1024
+
+bool parse_cpu_list(const std::string& spec, std::vector<int>& cpus) {
+    cpus.clear();
+    std::stringstream ss(spec);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        char* end;
+        long first = strtol(part.c_str(), &end, 10);
+        long last = first;
+        if (end == part.c_str() || first < 0) return false;
+        if (*end == '-') {
+            const char* rest = end + 1;
+            last = strtol(rest, &end, 10);
+            if (end == rest || last < first) return false;
+        }
+        if (*end != '\0' || last >= CPU_SETSIZE) return false;
+        for (long c = first; c <= last; ++c) cpus.push_back(c);
+    }
+    return !cpus.empty();
+}
+
+bool parse_numa_policy(const std::string& spec, PlacementConfig& config) {
+    config.numa_nodes.clear();
+    if (spec == "local") {
+        config.numa = NUMA_LOCAL;
+        return true;
+    }
+    size_t colon = spec.find(':');
+    if (colon == std::string::npos) return false;
+    std::string mode = spec.substr(0, colon);
+    if (mode == "bind") {
+        config.numa = NUMA_BIND;
+    } else if (mode == "interleave") {
+        config.numa = NUMA_INTERLEAVE;
+    } else {
+        return false;
+    }
+    return parse_cpu_list(spec.substr(colon + 1), config.numa_nodes);
+}
+
+bool check_placement(const PlacementConfig& config, std::string& error) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        error = "cannot read this process's CPU affinity";
+        return false;
+    }
+    for (const std::vector<int>* cpus : {&config.server_cpus, &config.train_cpus}) {
+        for (int cpu : *cpus) {
+            if (!CPU_ISSET(cpu, &allowed)) {
+                error = "CPU " + std::to_string(cpu) + " is offline or outside this process's affinity mask";
+                return false;
+            }
+        }
+    }
+    for (int node : config.numa_nodes) {
+        struct stat st;
+        std::string path = "/sys/devices/system/node/node" + std::to_string(node);
+        if (node >= MAX_NUMA_NODES || stat(path.c_str(), &st) != 0) {
+            error = "NUMA node " + std::to_string(node) + " does not exist";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+int server_cpu(const PlacementConfig& config, int shard) {
+    if (config.server_cpus.empty()) return -1;
+    return config.server_cpus[shard % config.server_cpus.size()];
+}
+
+int train_cpu(const PlacementConfig& config, int train_id) {
+    if (config.train_cpus.empty()) return -1;
+    return config.train_cpus[(train_id - 1) % config.train_cpus.size()];
+}
+
+bool place_memory(void* addr, size_t size, const PlacementConfig& config) {
+    if (config.numa == NUMA_DEFAULT) return true;
+
+    unsigned long mask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = {};
+    const size_t bits = 8 * sizeof(unsigned long);
+    for (int node : config.numa_nodes) mask[node / bits] |= 1UL << (node % bits);
+    int mode = config.numa == NUMA_BIND ? MPOL_BIND_MODE
+             : config.numa == NUMA_INTERLEAVE ? MPOL_INTERLEAVE_MODE : MPOL_LOCAL_MODE;
+    bool has_nodes = config.numa != NUMA_LOCAL;
+
+    // mbind wants a page-aligned start; segments from mmap always are
+    return syscall(SYS_mbind, addr, size, mode, has_nodes ? mask : nullptr, has_nodes ? MAX_NUMA_NODES + 1 : 0,
+                   MPOL_MF_MOVE_FLAG) == 0;
+}
+
+std::string describe_cpus(const std::vector<int>& cpus) {
+    if (cpus.empty()) return "any";
+    std::string out;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+        if (!out.empty()) out += ",";
+        out += std::to_string(cpus[i]);
+        if (j > i) out += "-" + std::to_string(cpus[j]);
+        i = j + 1;
+    }
+    return out;
+}
+
+std::string describe_numa(const PlacementConfig& config) {
+    switch (config.numa) {
+        case NUMA_DEFAULT:    return "default";
+        case NUMA_LOCAL:      return "local";
+        case NUMA_BIND:       return "bind:" + describe_cpus(config.numa_nodes);
+        case NUMA_INTERLEAVE: return "interleave:" + describe_cpus(config.numa_nodes);
+    }
+    return "?";
+}
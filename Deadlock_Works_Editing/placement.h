@@ -0,0 +1,52 @@
+// Group : I
+// Author: Samuel Shankle
+// Email: samuel.shankle@okstate.edu
+// Date: 10/19/2026
+// Description: Declares CPU and NUMA placement for a run. Server shards and trains can be pinned to cores, and the
+// shared segments bound to or interleaved across NUMA nodes, so forked processes stop drifting between sockets and
+// the table does not end up on whichever node main happened to touch it from.
+
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+enum NumaPolicy {
+    NUMA_DEFAULT,     // first touch, i.e. main's node
+    NUMA_LOCAL,       // explicitly first touch (MPOL_LOCAL)
+    NUMA_BIND,        // only the given nodes
+    NUMA_INTERLEAVE   // pages round-robin over the given nodes
+};
+
+struct PlacementConfig {
+    std::vector<int> server_cpus; // shard s runs on server_cpus[s % size], empty for unpinned
+    std::vector<int> train_cpus;  // train i runs on train_cpus[(i - 1) % size], empty for unpinned
+    NumaPolicy numa = NUMA_DEFAULT;
+    std::vector<int> numa_nodes;
+};
+
+// Parses a list like "0-3,8,10-11". Returns false on a bad or empty list.
+bool parse_cpu_list(const std::string& spec, std::vector<int>& cpus);
+
+// Parses "local", "bind:NODES" or "interleave:NODES" with NODES in the format of parse_cpu_list
+bool parse_numa_policy(const std::string& spec, PlacementConfig& config);
+
+// Checks every CPU is one this process may run on and every node exists. Fills error otherwise.
+bool check_placement(const PlacementConfig& config, std::string& error);
+
+// Pins the calling process (and whatever it forks later) to one CPU
+bool pin_to_cpu(int cpu);
+
+int server_cpu(const PlacementConfig& config, int shard); // -1 if unpinned
+int train_cpu(const PlacementConfig& config, int train_id);
+
+// Applies the NUMA policy to a mapped segment with mbind, moving pages already touched. A no-op
+// for NUMA_DEFAULT. Returns false with errno set if the kernel refused.
+bool place_memory(void* addr, size_t size, const PlacementConfig& config);
+
+std::string describe_cpus(const std::vector<int>& cpus);   // "0-3,8", or "any"
+std::string describe_numa(const PlacementConfig& config);  // "interleave:0-1", or "default"
+
+#endif // PLACEMENT_H
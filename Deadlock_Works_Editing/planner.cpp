@@ -0,0 +1,151 @@
+// Group : I
+// Author: Frantisek Zubek
+// Email: fero@okstate.edu
+// Date: 10/19/2026
+// Description: Offline route planner. Builds the conflict graph of trains whose routes share an intersection and
+// colors it into dispatch waves such that no wave asks any intersection for more than its capacity. Each train
+// then waits only for the trains in earlier waves it conflicts with, so no two trains ever contend.
+// Usage: ./planner [intersections.txt] [trains.txt] [schedule.txt]
+// Run the simulator with ./main --schedule=schedule.txt
+
+#include "parser.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <set>
+
+struct PlannedTrain {
+    std::string name;
+    std::set<int> uses;            // intersection indices on the route
+    int steps;                     // estimated time to traverse the route, one step per hop
+    std::vector<int> conflicts;    // trains sharing at least one intersection
+    int wave = -1;
+    std::vector<int> after;        // conflicting trains in earlier waves
+    long start = 0;                // estimated start, in steps
+};
+
+int main(int argc, char* argv[]) {
+    std::string intersections_path = argc > 1 ? argv[1] : "intersections.txt";
+    std::string trains_path = argc > 2 ? argv[2] : "trains.txt";
+    std::string schedule_path = argc > 3 ? argv[3] : "schedule.txt";
+
+    auto intersections = parseIntersections(intersections_path);
+    auto routes = parseTrains(trains_path);
+    if (intersections.empty() || routes.empty()) {
+        std::cerr << "Error: Failed to parse input files.\n";
+        return 1;
+    }
+
+    std::vector<std::string> names;
+    std::vector<int> capacity;
+    for (const auto& [name, inter] : intersections) {
+        names.push_back(name);
+        capacity.push_back(inter.capacity);
+    }
+    auto index_of = [&](const std::string& name) {
+        return (int)(std::find(names.begin(), names.end(), name) - names.begin());
+    };
+
+    std::vector<PlannedTrain> trains(routes.size());
+    std::vector<std::vector<int>> users(names.size()); // trains per intersection
+    for (size_t t = 0; t < routes.size(); ++t) {
+        trains[t].name = routes[t].trainName;
+        trains[t].steps = routes[t].route.size() + 1; // + the pause after the first grant
+        for (const std::string& inter : routes[t].route) {
+            int r = index_of(inter);
+            if (r == (int)names.size()) {
+                std::cerr << "Warning: " << trains[t].name << " uses unknown intersection " << inter << std::endl;
+                continue;
+            }
+            if (trains[t].uses.insert(r).second) users[r].push_back(t);
+        }
+    }
+
+    // Conflict graph: an edge wherever two routes share an intersection that cannot hold everyone using it
+    for (size_t r = 0; r < names.size(); ++r) {
+        if ((int)users[r].size() <= capacity[r]) continue;
+        for (int a : users[r]) {
+            for (int b : users[r]) {
+                if (a != b) trains[a].conflicts.push_back(b);
+            }
+        }
+    }
+    for (PlannedTrain& train : trains) {
+        std::sort(train.conflicts.begin(), train.conflicts.end());
+        train.conflicts.erase(std::unique(train.conflicts.begin(), train.conflicts.end()), train.conflicts.end());
+    }
+
+    // Longest routes first (they bound the makespan), most conflicted first among equals
+    std::vector<int> order(trains.size());
+    for (size_t t = 0; t < trains.size(); ++t) order[t] = t;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        if (trains[a].steps != trains[b].steps) return trains[a].steps > trains[b].steps;
+        return trains[a].conflicts.size() > trains[b].conflicts.size();
+    });
+
+    // Capacity-aware greedy coloring: the first wave in which every intersection on the route still has room
+    std::vector<std::vector<int>> load; // load[wave][intersection]
+    for (int t : order) {
+        int wave = 0;
+        while (true) {
+            if (wave == (int)load.size()) load.emplace_back(names.size(), 0);
+            bool fits = true;
+            for (int r : trains[t].uses) {
+                if (load[wave][r] >= capacity[r]) {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits) break;
+            wave++;
+        }
+        trains[t].wave = wave;
+        for (int r : trains[t].uses) load[wave][r]++;
+    }
+
+    // A train waits for every conflicting train in an earlier wave; trains sharing an intersection
+    // within a wave fit in its capacity, so nothing ever queues
+    long makespan = 0;
+    for (int wave = 0; wave < (int)load.size(); ++wave) {
+        for (PlannedTrain& train : trains) {
+            if (train.wave != wave) continue;
+            for (int other : train.conflicts) {
+                if (trains[other].wave < wave) {
+                    train.after.push_back(other);
+                    train.start = std::max(train.start, trains[other].start + trains[other].steps);
+                }
+            }
+            makespan = std::max(makespan, train.start + train.steps);
+        }
+    }
+    long serial = 0;
+    for (const PlannedTrain& train : trains) serial += train.steps;
+
+    std::ofstream out(schedule_path);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not write " << schedule_path << std::endl;
+        return 1;
+    }
+    out << "# Schedule for " << trains_path << " on " << intersections_path << "\n"
+        << "# Train:wave[:must finish first]\n"
+        << "# " << load.size() << " waves, estimated makespan " << makespan << " steps (one at a time: " << serial << ")\n";
+    for (const PlannedTrain& train : trains) {
+        out << train.name << ":" << train.wave;
+        for (size_t i = 0; i < train.after.size(); ++i) {
+            out << (i == 0 ? ":" : ",") << trains[train.after[i]].name;
+        }
+        out << "  # est start " << train.start << "\n";
+    }
+
+    std::cout << "Planned " << trains.size() << " trains in " << load.size() << " waves, estimated makespan "
+              << makespan << " steps (one at a time: " << serial << ")\n";
+    for (int wave = 0; wave < (int)load.size(); ++wave) {
+        std::cout << "  wave " << wave << ":";
+        for (const PlannedTrain& train : trains) {
+            if (train.wave == wave) std::cout << " " << train.name << "@" << train.start;
+        }
+        std::cout << "\n";
+    }
+    std::cout << "Schedule written to " << schedule_path << std::endl;
+    return 0;
+}
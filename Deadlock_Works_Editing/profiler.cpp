@@ -0,0 +1,182 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Implements per-intersection hold/wait accounting and the end-of-run hot intersection report.
+
+#include "profiler.h"
+#include "sync.h"
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <ctime>
+#include <cstring>
+
+long profiler_now_us() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000L;
+}
+
+LatencyHistogram::LatencyHistogram() : total(0), sum_us(0), max_us(0) {
+    memset(counts, 0, sizeof(counts));
+}
+
+// Values below 8 get their own bucket; above that each power of two is split into 8
+static int bucket_of(long us) {
+    if (us < LatencyHistogram::SUB_BUCKETS) return us < 0 ? 0 : (int)us;
+    int msb = 63 - __builtin_clzl((unsigned long)us);
+    int sub = (us >> (msb - 3)) & 7;
+    return (msb - 2) * LatencyHistogram::SUB_BUCKETS + sub;
+}
+
+static long bucket_value(int idx) {
+    if (idx < LatencyHistogram::SUB_BUCKETS) return idx;
+    int group = idx / LatencyHistogram::SUB_BUCKETS;
+    int sub = idx % LatencyHistogram::SUB_BUCKETS;
+    long lower = (long)(8 + sub) << (group - 1);
+    return lower + ((1L << (group - 1)) / 2); // middle of the bucket
+}
+
+void LatencyHistogram::add(long us) {
+    if (us < 0) us = 0;
+    counts[bucket_of(us)]++;
+    total++;
+    sum_us += us;
+    if (us > max_us) max_us = us;
+}
+
+long LatencyHistogram::percentile(double p) const {
+    if (total == 0) return 0;
+    long rank = (long)(p / 100.0 * total + 0.5);
+    if (rank < 1) rank = 1;
+    long seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            long value = bucket_value(i);
+            return value < max_us ? value : max_us;
+        }
+    }
+    return max_us;
+}
+
+ContentionProfiler::ContentionProfiler(int num_trains, int num_intersections)
+    : intersections(num_intersections), requested_at(num_trains, -1), requested_inter(num_trains, -1), holding(num_trains),
+      start_us(profiler_now_us()) {}
+
+void ContentionProfiler::requested(int train_idx, int inter_idx, long now_us) {
+    requested_at[train_idx] = now_us;
+    requested_inter[train_idx] = inter_idx;
+    intersections[inter_idx].acquisitions++;
+}
+
+void ContentionProfiler::blocked(int inter_idx) {
+    intersections[inter_idx].blocked++;
+}
+
+void ContentionProfiler::granted(int train_idx, int inter_idx, long now_us) {
+    if (requested_at[train_idx] >= 0) {
+        long waited = now_us - requested_at[train_idx];
+        intersections[inter_idx].wait.add(waited);
+        all_waits.add(waited);
+        requested_at[train_idx] = -1;
+    }
+    holding[train_idx].push_back({inter_idx, now_us});
+}
+
+void ContentionProfiler::released(int train_idx, int inter_idx, long now_us) {
+    std::vector<std::pair<int, long>>& held = holding[train_idx];
+    for (size_t i = 0; i < held.size(); ++i) {
+        if (held[i].first == inter_idx) {
+            intersections[inter_idx].hold.add(now_us - held[i].second);
+            held.erase(held.begin() + i);
+            return;
+        }
+    }
+}
+
+void ContentionProfiler::released_all(int train_idx, long now_us) {
+    for (const std::pair<int, long>& h : holding[train_idx]) {
+        intersections[h.first].hold.add(now_us - h.second);
+    }
+    holding[train_idx].clear();
+    if (requested_at[train_idx] >= 0) {
+        long waited = now_us - requested_at[train_idx];
+        intersections[requested_inter[train_idx]].wait.add(waited);
+        all_waits.add(waited);
+        requested_at[train_idx] = -1;
+    }
+}
+
+long ContentionProfiler::p99_wait_us() const {
+    return all_waits.percentile(99);
+}
+
+bool ContentionProfiler::write_report(const std::string& filename, SharedMemory* shm, long now_us) const {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    long run_us = now_us - start_us;
+    if (run_us <= 0) run_us = 1;
+
+    // Holds still open at the end of the run count toward utilization
+    std::vector<long> open_hold_us(intersections.size(), 0);
+    for (const auto& held : holding) {
+        for (const std::pair<int, long>& h : held) {
+            open_hold_us[h.first] += now_us - h.second;
+        }
+    }
+
+    // Rank by total time trains spent waiting: that is what extra capacity or a reroute buys back
+    std::vector<int> order(intersections.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        if (intersections[a].wait.sum_us != intersections[b].wait.sum_us) {
+            return intersections[a].wait.sum_us > intersections[b].wait.sum_us;
+        }
+        return intersections[a].hold.sum_us > intersections[b].hold.sum_us;
+    });
+
+    out << "HOT INTERSECTIONS (run " << std::fixed << std::setprecision(3) << run_us / 1e6 << " s, ranked by total wait)\n";
+    out << "times in ms; util = hold time / (capacity * run time)\n\n";
+    out << std::left << std::setw(5) << "RANK" << std::setw(20) << "INTERSECTION" << std::right
+        << std::setw(5) << "CAP" << std::setw(8) << "ACQ" << std::setw(9) << "BLOCKED"
+        << std::setw(11) << "WAIT TOT" << std::setw(9) << "WAIT p50" << std::setw(9) << "p95" << std::setw(9) << "p99"
+        << std::setw(11) << "HOLD TOT" << std::setw(9) << "HOLD p50" << std::setw(9) << "p95" << std::setw(9) << "p99"
+        << std::setw(7) << "UTIL" << "  SUGGESTION\n";
+
+    int rank = 1;
+    for (int i : order) {
+        const IntersectionProfile& p = intersections[i];
+        int capacity = shm->intersections[i].capacity > 0 ? shm->intersections[i].capacity : 1;
+        double util = (double)(p.hold.sum_us + open_hold_us[i]) / ((double)capacity * run_us);
+        double blocked_share = p.acquisitions > 0 ? (double)p.blocked / p.acquisitions : 0.0;
+
+        const char* suggestion = "";
+        if (p.blocked > 0 && util >= 0.8) {
+            suggestion = "add capacity";
+        } else if (blocked_share >= 0.25) {
+            suggestion = "reroute or stagger (bursty)";
+        }
+
+        out << std::left << std::setw(5) << rank++ << std::setw(20) << shm->intersections[i].name << std::right
+            << std::setw(5) << capacity << std::setw(8) << p.acquisitions << std::setw(9) << p.blocked
+            << std::setprecision(1)
+            << std::setw(11) << p.wait.sum_us / 1e3 << std::setw(9) << p.wait.percentile(50) / 1e3
+            << std::setw(9) << p.wait.percentile(95) / 1e3 << std::setw(9) << p.wait.percentile(99) / 1e3
+            << std::setw(11) << p.hold.sum_us / 1e3 << std::setw(9) << p.hold.percentile(50) / 1e3
+            << std::setw(9) << p.hold.percentile(95) / 1e3 << std::setw(9) << p.hold.percentile(99) / 1e3
+            << std::setprecision(2) << std::setw(7) << util << "  " << suggestion << "\n";
+    }
+
+    long acquisitions = 0;
+    for (const IntersectionProfile& p : intersections) acquisitions += p.acquisitions;
+
+    // all_waits also holds the waits of victims that never got their grant, so it is not the acquire count
+    out << "\nall intersections: acquisitions=" << acquisitions << " waits=" << all_waits.total
+        << " wait p50=" << std::setprecision(1) << all_waits.percentile(50) / 1e3
+        << " ms p99=" << all_waits.percentile(99) / 1e3 << " ms max=" << all_waits.max_us / 1e3 << " ms\n";
+    return true;
+}
@@ -0,0 +1,65 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Declares the per-intersection contention profiler the server uses to find bottleneck intersections.
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <vector>
+#include <string>
+#include <utility>
+
+struct SharedMemory;
+
+// Fixed-size log-linear histogram of microsecond durations (8 sub-buckets per power of two,
+// so percentiles are within ~12% of the true value) that never grows during a long run.
+struct LatencyHistogram {
+    static const int SUB_BUCKETS = 8;
+    static const int BUCKETS = 64 * SUB_BUCKETS;
+    long counts[BUCKETS];
+    long total;
+    long sum_us;
+    long max_us;
+
+    LatencyHistogram();
+    void add(long us);
+    long percentile(double p) const; // p in [0, 100]
+};
+
+struct IntersectionProfile {
+    LatencyHistogram hold;   // grant -> release
+    LatencyHistogram wait;   // request -> grant
+    long acquisitions = 0;
+    long blocked = 0;        // acquires that could not be granted immediately
+};
+
+struct ContentionProfiler {
+    std::vector<IntersectionProfile> intersections;
+    LatencyHistogram all_waits;
+    std::vector<long> requested_at;                 // per train: when its pending ACQUIRE arrived, or -1
+    std::vector<int> requested_inter;               // per train: what that ACQUIRE is for
+    std::vector<std::vector<std::pair<int, long>>> holding; // per train: (intersection, granted at)
+    long start_us;
+
+    ContentionProfiler(int num_trains, int num_intersections);
+
+    void requested(int train_idx, int inter_idx, long now_us);
+    void blocked(int inter_idx);
+    void granted(int train_idx, int inter_idx, long now_us);
+    void released(int train_idx, int inter_idx, long now_us);
+
+    // Deadlock victim: ends every hold, and its pending wait counts as ending now
+    void released_all(int train_idx, long now_us);
+
+    // p99 request -> grant latency over every intersection, in microseconds
+    long p99_wait_us() const;
+
+    // Writes the ranked "hot intersections" report. Returns false if the file could not be written.
+    bool write_report(const std::string& filename, SharedMemory* shm, long now_us) const;
+};
+
+// Monotonic clock in microseconds
+long profiler_now_us();
+
+#endif // PROFILER_H
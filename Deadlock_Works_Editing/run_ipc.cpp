@@ -0,0 +1,170 @@
+// Group : I
+// Author: Samuel Shankle
+// Email: samuel.shankle@okstate.edu
+// Date: 10/19/2026
+// Description: Implements run-scoped POSIX shared memory segments, the private message queue and their cleanup.
+
+#include "run_ipc.h"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <csignal>
+#include <climits>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/msg.h>
+
+#define SHM_DIR "/dev/shm"
+#define SEGMENT_PREFIX "trainsim."
+
+// Fixed arrays rather than strings so the signal handler never allocates
+static char created[MAX_RUN_SEGMENTS][NAME_MAX];
+static int num_created = 0;
+static int created_msgid = -1;
+static pid_t owner_pid = -1;
+
+std::string init_run_id(const std::string& requested) {
+    std::string run_id = requested;
+    if (run_id.empty()) {
+        const char* env = getenv(RUN_ID_ENV);
+        run_id = env && *env ? env : "p" + std::to_string(getpid());
+    }
+    setenv(RUN_ID_ENV, run_id.c_str(), 1);
+    return run_id;
+}
+
+std::string segment_name(const std::string& run_id, const char* what) {
+    return "/" SEGMENT_PREFIX + run_id + "." + what;
+}
+
+void* create_segment(const std::string& run_id, const char* what, size_t size) {
+    std::string name = segment_name(run_id, what);
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        if (errno == EEXIST) {
+            std::cerr << "Error: " << name << " exists, run ID " << run_id << " is already in use\n";
+        } else {
+            perror("shm_open");
+        }
+        return nullptr;
+    }
+    if (num_created < MAX_RUN_SEGMENTS) {
+        strncpy(created[num_created++], name.c_str(), NAME_MAX - 1);
+        owner_pid = getpid();
+    }
+    if (ftruncate(fd, size) < 0) {
+        perror("ftruncate");
+        close(fd);
+        return nullptr;
+    }
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return addr == MAP_FAILED ? nullptr : addr;
+}
+
+void* attach_segment(const std::string& run_id, const char* what, size_t size, bool read_only) {
+    int fd = shm_open(segment_name(run_id, what).c_str(), read_only ? O_RDONLY : O_RDWR, 0);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < size) {
+        close(fd);
+        return nullptr;
+    }
+    void* addr = mmap(nullptr, size, read_only ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return addr == MAP_FAILED ? nullptr : addr;
+}
+
+int create_run_queue() {
+    int msgid = msgget(IPC_PRIVATE, IPC_CREAT | 0600);
+    if (msgid < 0) {
+        perror("msgget");
+        return -1;
+    }
+    created_msgid = msgid;
+    owner_pid = getpid();
+    return msgid;
+}
+
+void cleanup_run_ipc() {
+    if (getpid() != owner_pid) return; // A forked child: the segments belong to the parent
+    for (int i = 0; i < num_created; ++i) {
+        shm_unlink(created[i]);
+    }
+    num_created = 0;
+    if (created_msgid != -1) {
+        msgctl(created_msgid, IPC_RMID, nullptr);
+        created_msgid = -1;
+    }
+}
+
+static void on_fatal_signal(int sig) {
+    cleanup_run_ipc();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+void install_run_cleanup() {
+    atexit(cleanup_run_ipc);
+    signal(SIGINT, on_fatal_signal);
+    signal(SIGTERM, on_fatal_signal);
+    signal(SIGHUP, on_fatal_signal);
+}
+
+int remove_stale_segments() {
+    DIR* dir = opendir(SHM_DIR);
+    if (!dir) return 0;
+    int removed = 0;
+    const size_t prefix_len = strlen(SEGMENT_PREFIX);
+    while (dirent* entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (strncmp(name, SEGMENT_PREFIX "p", prefix_len + 1) != 0) continue;
+        char* end;
+        long pid = strtol(name + prefix_len + 1, &end, 10);
+        if (*end != '.' || pid <= 0) continue; // Not a default ID, so we cannot tell who owns it
+        if (kill(pid, 0) == -1 && errno == ESRCH) {
+            if (shm_unlink((std::string("/") + name).c_str()) == 0) removed++;
+        }
+    }
+    closedir(dir);
+    return removed;
+}
+
+int remove_run_segments(const std::string& run_id) {
+    DIR* dir = opendir(SHM_DIR);
+    if (!dir) return 0;
+    int removed = 0;
+    const std::string prefix = SEGMENT_PREFIX + run_id + ".";
+    while (dirent* entry = readdir(dir)) {
+        if (strncmp(entry->d_name, prefix.c_str(), prefix.size()) != 0) continue;
+        if (shm_unlink((std::string("/") + entry->d_name).c_str()) == 0) removed++;
+    }
+    closedir(dir);
+    return removed;
+}
+
+std::string latest_run_id() {
+    DIR* dir = opendir(SHM_DIR);
+    if (!dir) return "";
+    std::string latest;
+    time_t latest_time = 0;
+    const std::string suffix = ".stats";
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.rfind(SEGMENT_PREFIX, 0) != 0 || name.size() <= strlen(SEGMENT_PREFIX) + suffix.size() ||
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            continue;
+        }
+        struct stat st;
+        if (stat((std::string(SHM_DIR "/") + name).c_str(), &st) == 0 && st.st_mtime >= latest_time) {
+            latest_time = st.st_mtime;
+            latest = name.substr(strlen(SEGMENT_PREFIX), name.size() - strlen(SEGMENT_PREFIX) - suffix.size());
+        }
+    }
+    closedir(dir);
+    return latest;
+}
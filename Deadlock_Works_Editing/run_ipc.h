@@ -0,0 +1,49 @@
+// Group : I
+// Author: Samuel Shankle
+// Email: samuel.shankle@okstate.edu
+// Date: 10/19/2026
+// Description: Declares run-scoped IPC. Every shared memory segment is a POSIX segment named after the run ID and
+// the message queue is private, so several simulations can share a host and nothing outlives its run.
+
+#ifndef RUN_IPC_H
+#define RUN_IPC_H
+
+#include <string>
+#include <cstddef>
+
+#define RUN_ID_ENV "TRAINSIM_RUN_ID"
+#define MAX_RUN_SEGMENTS 8
+
+// Returns TRAINSIM_RUN_ID if set, otherwise "p<pid>". Either way the ID is exported so forked
+// children and anything they exec see the same run.
+std::string init_run_id(const std::string& requested = "");
+
+// POSIX name of a run's segment, e.g. "/trainsim.p1234.stats"
+std::string segment_name(const std::string& run_id, const char* what);
+
+// Creates, sizes and maps a new segment and registers it for cleanup. Returns nullptr if it
+// already exists (another live run with the same ID) or cannot be created.
+void* create_segment(const std::string& run_id, const char* what, size_t size);
+
+// Maps an existing segment. Returns nullptr if it does not exist or is smaller than size.
+void* attach_segment(const std::string& run_id, const char* what, size_t size, bool read_only);
+
+// Creates a private SysV message queue and registers it for cleanup. Returns -1 on error.
+int create_run_queue();
+
+// Removes everything this process created on exit or on SIGINT / SIGTERM / SIGHUP.
+// Forked children inherit the handlers but never remove their parent's segments.
+void install_run_cleanup();
+void cleanup_run_ipc();
+
+// Unlinks segments left behind by runs with a default ID whose process no longer exists
+// (e.g. killed with SIGKILL). Returns how many segments were removed.
+int remove_stale_segments();
+
+// Unlinks every segment of the named run, for runners that had to SIGKILL it. Returns how many were removed.
+int remove_run_segments(const std::string& run_id);
+
+// Run ID of the most recently created stats segment on this host, or "" if there is none
+std::string latest_run_id();
+
+#endif // RUN_IPC_H
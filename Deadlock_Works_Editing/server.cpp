@@ -0,0 +1,938 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Implements the server process. Intersections are granted without blocking the server, trains that
+// cannot be granted wait in a FIFO per intersection, and deadlock detection runs according to the configured policy.
+// With several shards each server owns the intersections that hash to it and only detects deadlocks among those.
+// Checkpoints are written by a forked child so the server only pauses for the fork itself.
+// Capacities can be reloaded from the intersections file while trains are running.
+
+#include "server.h"
+#include "message.h"
+#include "detect_deadlock.h"
+#include "thread_pool.h"
+#include "profiler.h"
+#include "transport.h"
+#include "checkpoint.h"
+#include "parser.h"
+#include "trace.h"
+#include <iostream>
+#include <deque>
+#include <algorithm>
+#include <cstring>
+#include <csignal>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <sys/inotify.h>
+
+struct WaitingTrain {
+    int train_id;
+    long since_ms;
+};
+
+// One difference between the intersections file and the live table
+struct IntersectionChange {
+    std::string name;
+    int capacity; // 0 retires it
+};
+
+// A cycle that spans shards is invisible to every shard's detector, so with more than one
+// shard a train blocked this long is aborted instead. The limit is staggered by train so
+// both ends of a two-shard cycle do not time out together and restart into the same cycle.
+#define CROSS_SHARD_TIMEOUT_MS 2000
+#define SHARD_TICK_MS 250
+
+// Most requests drained from the transport into one batch
+#define SERVER_BATCH_MAX 256
+
+// Components only ever merge, so they are rebuilt from the live edges at most this often
+#define COMPONENT_REBUILD_MS 1000
+
+static ServerTransport* transport = nullptr;
+static int my_shard = 0;
+static int num_shards = 1;
+static std::vector<std::deque<WaitingTrain>> waiting; // Blocked trains per intersection, oldest first
+static std::vector<int> waiting_on;                    // Intersection each train is blocked on, or -1
+static std::vector<long> waiting_since;                // Wall time each train started waiting
+static DetectionOverhead overhead;
+static ThreadPool* detect_pool = nullptr;
+static ContentionProfiler* profiler = nullptr;
+static std::vector<int> route_pos;                     // Acquires answered per train in its current attempt
+static std::vector<bool> route_done;                   // Train has started releasing
+static pid_t checkpoint_pid = -1;                      // Child writing the current checkpoint, or -1
+static long checkpoint_seq = 0;
+static long last_checkpoint_ms = 0;
+static long last_component_rebuild_ms = 0;
+static std::vector<std::string> inter_names;           // Slot names as this shard knows them, incl. other shards' new ones
+static std::deque<IntersectionChange> pending_changes; // Left from the last reload, applied one per loop iteration
+static std::vector<bool> resize_deferred;              // Switch back to a mutex waiting for the intersection to drain
+static int inotify_fd = -1;
+static std::string watched_file;                       // Intersections file name within the watched directory
+static volatile sig_atomic_t file_event = 0;
+static std::vector<int> batch_acquires;                // Acquires per train in the batch being applied
+static int num_waiting = 0;                            // Trains in any of this shard's wait queues
+
+static long now_ms() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static long cpu_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static long sim_now() {
+    pthread_mutex_lock(time_mutex);
+    long now = *sim_time;
+    pthread_mutex_unlock(time_mutex);
+    return now;
+}
+
+// SIGALRM only exists to interrupt the blocking receive so time-based policies are re-evaluated while idle
+static void on_tick(int) {}
+
+// SIGIO from the inotify descriptor interrupts the receive the same way
+static void on_file_event(int) {
+    file_event = 1;
+}
+
+static void send_reply(int train_id, const char* command, const std::string& inter, int retry_after_ms = 0) {
+    TrainMessage reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.type = REPLY_TYPE(train_id);
+    reply.train_id = train_id;
+    strncpy(reply.command, command, sizeof(reply.command) - 1);
+    strncpy(reply.intersection, inter.c_str(), sizeof(reply.intersection) - 1);
+    reply.retry_after_ms = retry_after_ms;
+    transport->send(reply);
+    if (stats && train_id <= MAX_STAT_TRAINS) stat_add(stats->trains[train_id - 1].replies);
+}
+
+static bool owned(int inter_idx) {
+    return shard_of(inter_names[inter_idx], num_shards) == my_shard;
+}
+
+// Mirrors an intersection's holder count into the stats segment
+static void publish_occupancy(int inter_idx) {
+    if (stats) stat_set(stats->intersections[inter_idx].occupancy, shm->locks[inter_idx].num_holding_trains);
+}
+
+// Trace span ids: a train waits for one intersection at a time, and holds each at most once
+static long hold_span_id(int train_idx, int inter_idx) {
+    return (long)train_idx * 65536 + inter_idx;
+}
+
+static void trace_span(char phase, int train_idx, int inter_idx, bool hold) {
+    if (!trace_enabled()) return;
+    trace_train_span(phase, train_idx + 1, (hold ? "hold " : "wait ") + inter_names[inter_idx], hold ? "hold" : "wait",
+                     hold ? hold_span_id(train_idx, inter_idx) : train_idx, profiler_now_us());
+}
+
+// Records a grant in the matrices and tells the train
+static void grant(int train_id, int inter_idx, Logger& logger) {
+    int train_idx = train_id - 1;
+    request[train_idx][inter_idx] = 0;
+    allocation[train_idx][inter_idx] = 1;
+    available[inter_idx]--;
+    route_pos[train_idx]++;
+    profiler->granted(train_idx, inter_idx, profiler_now_us());
+    trace_span('b', train_idx, inter_idx, true);
+    if (stats) {
+        stat_add(stats->grants);
+        stat_add(stats->intersections[inter_idx].grants);
+        publish_occupancy(inter_idx);
+    }
+
+    std::string inter = shm->intersections[inter_idx].name;
+    send_reply(train_id, "granted", inter);
+    logger.log_server("Granted " + inter + " to Train" + std::to_string(train_id));
+}
+
+// Hands a freed intersection to waiting trains in arrival order
+static void grant_waiters(int inter_idx, Logger& logger) {
+    if (resize_deferred[inter_idx]) {
+        resize_deferred[inter_idx] = !resize_intersection(inter_idx, shm->intersections[inter_idx].capacity, shm);
+    }
+    std::deque<WaitingTrain>& queue = waiting[inter_idx];
+    while (!queue.empty() && try_acquire_intersection(queue.front().train_id, inter_idx, shm)) {
+        int train_id = queue.front().train_id;
+        queue.pop_front();
+        waiting_on[train_id - 1] = -1;
+        num_waiting--;
+        trace_span('e', train_id - 1, inter_idx, false);
+        if (stats) stat_add(stats->intersections[inter_idx].queue_depth, -1);
+        grant(train_id, inter_idx, logger);
+    }
+}
+
+static long oldest_wait_ms(long now) {
+    long oldest = -1;
+    for (size_t t = 0; t < waiting_on.size(); ++t) {
+        if (waiting_on[t] != -1 && now - waiting_since[t] > oldest) {
+            oldest = now - waiting_since[t];
+        }
+    }
+    return oldest;
+}
+
+static bool component_deadlocked(int train_idx) {
+    const std::vector<int>& trains = components->trains_with(train_idx);
+    const std::vector<int>& resources = components->intersections_with(train_idx);
+    if (detect_pool && (long)trains.size() >= detection_policy.parallel_min_trains) {
+        return detect_deadlock_parallel(allocation, request, available, trains, resources, *detect_pool);
+    }
+    return detect_deadlock_dispatch(allocation, request, available, trains, resources);
+}
+
+// Drops a victim's pending request, tells it to restart its route and hands everything it
+// held to the next waiters. The matrices were already cleared by recover_from_deadlock.
+// timed_out marks a cross-shard timeout rather than a detected deadlock.
+static void abort_train(int victim, bool timed_out, Logger& logger) {
+    for (const std::pair<int, long>& held : profiler->holding[victim]) {
+        trace_span('e', victim, held.first, true);
+    }
+    if (trace_enabled()) {
+        trace_instant(TRACE_TRAINS_PID, victim + 1, "aborted", "recovery", profiler_now_us());
+    }
+    profiler->released_all(victim, profiler_now_us());
+
+    long waited = now_ms() - waiting_since[victim];
+    if (timed_out) {
+        overhead.timeouts++;
+        overhead.timeout_wait_ms_total += waited;
+        if (waited > overhead.timeout_wait_ms_max) overhead.timeout_wait_ms_max = waited;
+    } else {
+        overhead.recover_wait_ms_total += waited;
+        if (waited > overhead.recover_wait_ms_max) overhead.recover_wait_ms_max = waited;
+    }
+
+    int blocked_on = waiting_on[victim];
+    std::deque<WaitingTrain>& queue = waiting[blocked_on];
+    for (auto it = queue.begin(); it != queue.end(); ++it) {
+        if (it->train_id == victim + 1) {
+            queue.erase(it);
+            break;
+        }
+    }
+    waiting_on[victim] = -1;
+    num_waiting--;
+    trace_span('e', victim, blocked_on, false);
+    route_pos[victim] = 0;
+    send_reply(victim + 1, "abort", shm->intersections[blocked_on].name);
+    if (stats) {
+        stat_add(stats->recoveries);
+        stat_add(stats->intersections[blocked_on].queue_depth, -1);
+    }
+
+    for (int r : components->intersections_with(victim)) {
+        publish_occupancy(r);
+        grant_waiters(r, logger);
+    }
+}
+
+// Runs detection on the component containing train_idx and recovers until it is deadlock free
+static void check_component(int train_idx, Logger& logger) {
+    logger.log_server("Deadlock check triggered");
+
+    long trace_start = profiler_now_us();
+    int recovered = 0;
+    int component_trains = components->trains_with(train_idx).size();
+    while (true) {
+        long start = cpu_ns();
+        bool deadlocked = component_deadlocked(train_idx);
+        overhead.detect_cpu_ns += cpu_ns() - start;
+        if (!deadlocked) break;
+        logger.log_server("Deadlock detected.");
+        overhead.deadlocks++;
+        if (stats) stat_add(stats->deadlocks);
+
+        // Only trains blocked on a request can be part of a cycle
+        start = cpu_ns();
+        std::vector<int> candidates;
+        for (int t : components->trains_with(train_idx)) {
+            if (waiting_on[t] != -1) candidates.push_back(t);
+        }
+        int victim = choose_victim(allocation, candidates);
+        overhead.detect_cpu_ns += cpu_ns() - start;
+        if (victim == -1) break;
+
+        // Releasing the victim's holds and granting them to waiters is grant work, not detection
+        start = cpu_ns();
+        recover_from_deadlock(allocation, request, available, shm, logger, {victim});
+        abort_train(victim, false, logger);
+        overhead.grant_cpu_ns += cpu_ns() - start;
+        recovered++;
+    }
+    if (trace_enabled()) {
+        trace_slice(getpid(), my_shard, "detect_deadlock", "detect", trace_start, profiler_now_us() - trace_start,
+                    "\"trains\":" + std::to_string(component_trains) + ",\"victims\":" + std::to_string(recovered));
+    }
+}
+
+// Runs detection if the policy says it is due. trains are the trains whose requests the
+// batch applied, empty when woken by the timer.
+static void maybe_detect(const std::vector<int>& trains, Logger& logger) {
+    long now = now_ms();
+    if (!detection_due(detection_policy, now, sim_now(), oldest_wait_ms(now))) {
+        return;
+    }
+
+    overhead.checks++;
+    if (now - last_component_rebuild_ms >= COMPONENT_REBUILD_MS && components->largest_trains > 1) {
+        overhead.max_component_trains = std::max<long>(overhead.max_component_trains, components->largest_trains);
+        components->rebuild(allocation, request);
+        overhead.component_rebuilds++;
+        last_component_rebuild_ms = now;
+    }
+    if (detection_policy.mode == DETECT_EVERY_REQUEST && !trains.empty()) {
+        // Each component the batch touched, once
+        std::vector<bool> checked(waiting_on.size() + available.size(), false);
+        for (int t : trains) {
+            int root = components->find(t);
+            if (checked[root]) continue;
+            checked[root] = true;
+            check_component(t, logger);
+        }
+    } else {
+        // Deferred check: every component with a blocked train, each checked once
+        std::vector<bool> checked(waiting_on.size() + available.size(), false);
+        for (size_t t = 0; t < waiting_on.size(); ++t) {
+            if (waiting_on[t] == -1) continue;
+            int root = components->find(t);
+            if (checked[root]) continue;
+            checked[root] = true;
+            check_component(t, logger);
+        }
+    }
+    detection_ran(detection_policy, now_ms(), sim_now());
+}
+
+static long cross_shard_timeout_ms(int train_idx) {
+    return CROSS_SHARD_TIMEOUT_MS + (train_idx % 8) * SHARD_TICK_MS;
+}
+
+// Whether a train holds an intersection on any shard. The shared table has every shard's
+// holders, where this shard's matrices only have its own.
+static bool holds_any_intersection(int train_id) {
+    pthread_mutex_lock(&shm->shared_memory_mutex);
+    bool holds = false;
+    for (int r = 0; r < (int)available.size() && !holds; ++r) {
+        const IntersectionLock& lock = shm->locks[r];
+        for (int h = 0; h < lock.num_holding_trains && h < MAX_TRAINS_AT_INTERSECTION; ++h) {
+            if (lock.holding_trains[h] == train_id) holds = true;
+        }
+    }
+    pthread_mutex_unlock(&shm->shared_memory_mutex);
+    return holds;
+}
+
+// Aborts the longest waiter once it has waited past its cross-shard timeout. The train
+// releases whatever it holds on other shards when it sees the abort. A train holding
+// nothing anywhere cannot be part of a cycle, so it is left waiting.
+static void expire_cross_shard_waits(Logger& logger) {
+    long now = now_ms();
+    int oldest = -1;
+    for (size_t t = 0; t < waiting_on.size(); ++t) {
+        if (waiting_on[t] != -1 && now - waiting_since[t] >= cross_shard_timeout_ms(t) &&
+            (oldest == -1 || waiting_since[t] < waiting_since[oldest]) && holds_any_intersection(t + 1)) {
+            oldest = t;
+        }
+    }
+    if (oldest == -1) return;
+
+    logger.log_server("Train" + std::to_string(oldest + 1) + " waited " + std::to_string(now - waiting_since[oldest]) +
+                      " ms, assuming a cross-shard deadlock");
+    recover_from_deadlock(allocation, request, available, shm, logger, {oldest});
+    abort_train(oldest, true, logger);
+}
+
+static void handle_acquire(int train_id, int inter_idx, Logger& logger) {
+    int train_idx = train_id - 1;
+    if (allocation[train_idx][inter_idx]) {
+        // A route through the same intersection twice: still held from the first visit, so the
+        // answer is yes without taking another slot
+        route_pos[train_idx]++;
+        send_reply(train_id, "granted", shm->intersections[inter_idx].name);
+        logger.log_server("Train" + std::to_string(train_id) + " already holds " + shm->intersections[inter_idx].name);
+        return;
+    }
+    request[train_idx][inter_idx] = 1;
+    components->link(train_idx, inter_idx);
+    profiler->requested(train_idx, inter_idx, profiler_now_us());
+
+    // Trains already queued keep their place ahead of new arrivals
+    if (waiting[inter_idx].empty() && try_acquire_intersection(train_id, inter_idx, shm)) {
+        grant(train_id, inter_idx, logger);
+        return;
+    }
+
+    long now = now_ms();
+    profiler->blocked(inter_idx);
+    trace_span('b', train_idx, inter_idx, false);
+    waiting[inter_idx].push_back({train_id, now});
+    waiting_on[train_idx] = inter_idx;
+    waiting_since[train_idx] = now;
+    num_waiting++;
+    if (stats) {
+        stat_add(stats->waits);
+        stat_add(stats->intersections[inter_idx].waits);
+        stat_add(stats->intersections[inter_idx].queue_depth);
+    }
+    logger.log_server("Train" + std::to_string(train_id) + " waiting for " + shm->intersections[inter_idx].name);
+}
+
+static void handle_release(int train_id, int inter_idx, Logger& logger) {
+    int train_idx = train_id - 1;
+    if (allocation[train_idx][inter_idx] == 0) {
+        return; // Already force-released when the train was aborted
+    }
+    handle_release_request(train_id, shm->intersections[inter_idx].name, shm);
+    allocation[train_idx][inter_idx] = 0;
+    available[inter_idx]++;
+    route_done[train_idx] = true;
+    profiler->released(train_idx, inter_idx, profiler_now_us());
+    trace_span('e', train_idx, inter_idx, true);
+    publish_occupancy(inter_idx);
+    grant_waiters(inter_idx, logger);
+}
+
+// Puts back the holdings and wait queues of a checkpoint before any train reconnects
+static void restore_checkpoint(const Checkpoint& checkpoint, Logger& logger) {
+    long now = now_ms();
+    for (size_t t = 0; t < checkpoint.trains.size(); ++t) {
+        const TrainCheckpoint& train = checkpoint.trains[t];
+        route_pos[t] = train.route_pos;
+        route_done[t] = train.done;
+        if (train.done) continue; // It was only releasing, so it leaves nothing behind
+
+        for (int r : train.held) {
+            if (!try_acquire_intersection(t + 1, r, shm)) {
+                std::cerr << "Error: Checkpoint over-subscribes " << shm->intersections[r].name << std::endl;
+                continue;
+            }
+            allocation[t][r] = 1;
+            available[r]--;
+            components->link(t, r);
+            profiler->granted(t, r, profiler_now_us());
+            publish_occupancy(r);
+        }
+        if (train.waiting_on != -1) {
+            request[t][train.waiting_on] = 1;
+            components->link(t, train.waiting_on);
+            waiting_on[t] = train.waiting_on;
+            waiting_since[t] = now - train.waited_ms;
+        }
+    }
+    for (size_t r = 0; r < checkpoint.queues.size(); ++r) {
+        for (int t : checkpoint.queues[r]) {
+            waiting[r].push_back({t + 1, waiting_since[t]});
+            num_waiting++;
+            if (stats) stat_add(stats->intersections[r].queue_depth);
+        }
+    }
+    logger.log_server("Resumed from checkpoint " + std::to_string(checkpoint.sequence));
+}
+
+// Snapshots the server state once checkpoint_interval_ms has passed. fork() gives the child a
+// copy-on-write image of the matrices and queues, so the server only waits for the page tables
+// to be copied while the child serializes and syncs the file.
+static void maybe_checkpoint(Logger& logger) {
+    if (checkpoint_path.empty()) return;
+    if (checkpoint_pid != -1) {
+        if (waitpid(checkpoint_pid, nullptr, WNOHANG) == 0) return; // Previous one still writing
+        checkpoint_pid = -1;
+    }
+    long now = now_ms();
+    if (now - last_checkpoint_ms < checkpoint_interval_ms) return;
+    last_checkpoint_ms = now;
+    checkpoint_seq++;
+
+    long start = profiler_now_us();
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork checkpoint");
+        return;
+    }
+    if (pid == 0) {
+        Checkpoint checkpoint;
+        checkpoint.sequence = checkpoint_seq;
+        checkpoint.sim_time = sim_now();
+        for (size_t r = 0; r < available.size(); ++r) {
+            checkpoint.intersections.push_back(shm->intersections[r].name);
+            checkpoint.queues.emplace_back();
+            for (const WaitingTrain& w : waiting[r]) checkpoint.queues[r].push_back(w.train_id - 1);
+        }
+        checkpoint.trains.resize(allocation.size());
+        for (size_t t = 0; t < allocation.size(); ++t) {
+            TrainCheckpoint& train = checkpoint.trains[t];
+            train.route_pos = route_pos[t];
+            train.done = route_done[t];
+            train.waiting_on = waiting_on[t];
+            train.waited_ms = waiting_on[t] == -1 ? 0 : now - waiting_since[t];
+            for (size_t r = 0; r < allocation[t].size(); ++r) {
+                if (allocation[t][r] == 1) train.held.push_back(r);
+            }
+        }
+        _exit(save_checkpoint(checkpoint_path, checkpoint) ? 0 : 1);
+    }
+
+    checkpoint_pid = pid;
+    logger.log_server("Checkpoint " + std::to_string(checkpoint_seq) + " started, server paused " +
+                      std::to_string(profiler_now_us() - start) + " us");
+}
+
+// Watches the directory rather than the file, so editors that save by renaming a new copy over
+// the old one are seen too. The descriptor raises SIGIO so an idle server notices at once.
+static void watch_intersections_file(Logger& logger) {
+    size_t slash = intersections_path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : intersections_path.substr(0, slash == 0 ? 1 : slash);
+    watched_file = slash == std::string::npos ? intersections_path : intersections_path.substr(slash + 1);
+
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0 || inotify_add_watch(inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        perror("inotify");
+        if (inotify_fd >= 0) close(inotify_fd);
+        inotify_fd = -1;
+        return;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_file_event;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0; // No SA_RESTART, so an event interrupts the receive
+    sigaction(SIGIO, &sa, nullptr);
+    fcntl(inotify_fd, F_SETOWN, getpid());
+    fcntl(inotify_fd, F_SETFL, fcntl(inotify_fd, F_GETFL) | O_ASYNC);
+    logger.log_server("Watching " + intersections_path + " for capacity changes");
+}
+
+// Drains pending inotify events. Returns true if any of them was for the intersections file.
+static bool intersections_file_written() {
+    file_event = 0;
+    alignas(inotify_event) char buf[4096];
+    bool written = false;
+    ssize_t n;
+    while ((n = read(inotify_fd, buf, sizeof(buf))) > 0) {
+        for (char* p = buf; p < buf + n;) {
+            inotify_event* event = (inotify_event*)p;
+            if (event->len > 0 && watched_file == event->name) written = true;
+            p += sizeof(inotify_event) + event->len;
+        }
+    }
+    return written;
+}
+
+static int known_intersection(const std::string& name) {
+    auto it = std::find(inter_names.begin(), inter_names.end(), name);
+    return it == inter_names.end() ? -1 : it - inter_names.begin();
+}
+
+// Diffs the intersections file against the live table. Only the parse happens here; the changes
+// are queued and applied one per loop iteration, so no request waits behind a whole reload.
+static void start_reload(Logger& logger) {
+    auto parsed = parseIntersections(intersections_path);
+    if (parsed.empty()) {
+        logger.log_server("Reload: could not parse " + intersections_path + ", keeping the current table");
+        return;
+    }
+
+    pending_changes.clear(); // Recomputed from the live table, so nothing of an older reload is lost
+    for (size_t r = 0; r < inter_names.size(); ++r) {
+        if (owned(r) && shm->intersections[r].capacity > 0 && !parsed.count(inter_names[r])) {
+            pending_changes.push_back({inter_names[r], 0});
+        }
+    }
+    std::vector<std::string> added;
+    for (const auto& [name, inter] : parsed) {
+        if (inter.capacity < 1 || inter.capacity > MAX_TRAINS_AT_INTERSECTION) {
+            logger.log_server("Reload: ignoring " + name + " with capacity " + std::to_string(inter.capacity));
+            continue;
+        }
+        int r = known_intersection(name);
+        if (r == -1) {
+            added.push_back(name);
+        } else if (owned(r) && shm->intersections[r].capacity != inter.capacity) {
+            pending_changes.push_back({name, inter.capacity});
+        }
+    }
+    // Every shard must give a new intersection the same slot, so not the map's hash order
+    std::sort(added.begin(), added.end());
+    for (const std::string& name : added) {
+        pending_changes.push_back({name, parsed[name].capacity});
+    }
+    logger.log_server("Reload: " + std::to_string(pending_changes.size()) + " changes from " + intersections_path);
+}
+
+// A retired intersection is never granted again, so its queue is told to go on without it
+static void deny_waiters(int inter_idx, Logger& logger) {
+    std::deque<WaitingTrain>& queue = waiting[inter_idx];
+    while (!queue.empty()) {
+        int train_id = queue.front().train_id;
+        int train_idx = train_id - 1;
+        queue.pop_front();
+        request[train_idx][inter_idx] = 0;
+        waiting_on[train_idx] = -1;
+        num_waiting--;
+        trace_span('e', train_idx, inter_idx, false);
+        route_pos[train_idx]++;
+        if (stats) stat_add(stats->intersections[inter_idx].queue_depth, -1);
+        send_reply(train_id, "denied", inter_names[inter_idx]);
+        logger.log_server("Train" + std::to_string(train_id) + " denied retired " + inter_names[inter_idx]);
+    }
+}
+
+// Gives a new intersection the next free slot. Every shard grows its tables; only the owner
+// fills in the shared slot.
+static void add_intersection(const IntersectionChange& change, Logger& logger) {
+    int r = available.size();
+    if (r >= MAX_INTERSECTIONS) {
+        logger.log_server("Reload: no free slot for " + change.name);
+        return;
+    }
+    inter_names.push_back(change.name);
+    if (owned(r)) {
+        IntersectionData* intersection = &shm->intersections[r];
+        pthread_mutex_lock(&shm->shared_memory_mutex);
+        table_write_begin(shm);
+        strncpy(intersection->name, change.name.c_str(), MAX_INTERSECTION_NAME_LENGTH - 1);
+        intersection->capacity = change.capacity;
+        intersection->lock_type = change.capacity == 1 ? 1 : change.capacity;
+        table_write_end(shm);
+        pthread_mutex_unlock(&shm->shared_memory_mutex);
+        ticket_init(&shm->semaphores[r], change.capacity);
+        if (stats) {
+            strncpy(stats->intersections[r].name, intersection->name, MAX_INTERSECTION_NAME_LENGTH);
+            stat_set(stats->intersections[r].capacity, change.capacity);
+            stats->intersections[r].ready.store(1, std::memory_order_release);
+            // Owners of later slots may get here first, so readers check each row's ready flag
+            stat_max(stats->num_intersections, r + 1);
+        }
+    }
+
+    available.push_back(change.capacity);
+    for (std::vector<int>& row : allocation) row.push_back(0);
+    for (std::vector<int>& row : request) row.push_back(0);
+    waiting.emplace_back();
+    resize_deferred.push_back(false);
+    components->add_intersection();
+    profiler->intersections.emplace_back();
+    logger.log_server("Reload: added " + change.name + " with capacity " + std::to_string(change.capacity));
+}
+
+// Applies one queued change: the cost of a single release plus its grants
+static void apply_change(const IntersectionChange& change, Logger& logger) {
+    int r = known_intersection(change.name);
+    if (r == -1) {
+        add_intersection(change, logger);
+        return;
+    }
+    int old_capacity = shm->intersections[r].capacity;
+    if (change.capacity == old_capacity) return;
+
+    available[r] += change.capacity - old_capacity; // Negative until holders over a smaller capacity leave
+    resize_deferred[r] = !resize_intersection(r, change.capacity, shm);
+    if (stats) stat_set(stats->intersections[r].capacity, change.capacity);
+    logger.log_server("Reload: " + change.name + " capacity " + std::to_string(old_capacity) + " -> " +
+                      std::to_string(change.capacity) + (change.capacity == 0 ? " (retired)" : ""));
+
+    if (change.capacity == 0) {
+        deny_waiters(r, logger);
+    } else if (change.capacity > old_capacity) {
+        grant_waiters(r, logger);
+    }
+}
+
+// Index of a request's train, or -1 (logged) if there is no such train
+static int request_train(const TrainMessage& msg, Logger& logger) {
+    int train_idx = msg.train_id - 1;
+    if (train_idx < 0 || train_idx >= (int)allocation.size()) {
+        logger.log_server("Unknown train " + std::to_string(msg.train_id));
+        return -1;
+    }
+    return train_idx;
+}
+
+static bool is_acquire(const TrainMessage& msg) {
+    return strcmp(msg.command, "advance") == 0 || strcmp(msg.command, "acquire") == 0 ||
+           strcmp(msg.command, "resume") == 0;
+}
+
+// Applies a release, or the release half of a hand-over-hand advance, which frees the hop
+// behind the train before its acquire half is handled like an acquire
+static void apply_release(const TrainMessage& msg, Logger& logger) {
+    bool advance = strcmp(msg.command, "advance") == 0;
+    const char* name = advance ? msg.from : msg.intersection;
+    int inter_idx = find_intersection_index(name, shm);
+    if (inter_idx >= 0 && inter_idx < (int)available.size() && owned(inter_idx)) {
+        handle_release(msg.train_id, inter_idx, logger);
+    } else if (!advance) {
+        logger.log_server("Unknown intersection " + std::string(name) + " from Train" + std::to_string(msg.train_id) +
+                          " on shard " + std::to_string(my_shard));
+    }
+}
+
+// Admission control for an acquire that passed the checks above. One that can be granted
+// now is always admitted, and so is one from a train already holding an intersection here:
+// turning that train away would keep its request out of detection while it holds what others
+// wait for. Otherwise the acquire is answered BUSY when this shard already has
+// admission.max_inflight trains waiting, or its train has more than admission.max_train_inflight
+// acquires outstanding here. Releases do not count, so a hop's release plus acquire is one.
+static bool admit(const TrainMessage& msg, int inter_idx, Logger& logger) {
+    int train_idx = msg.train_id - 1;
+    int train_inflight = batch_acquires[train_idx] + (waiting_on[train_idx] != -1);
+    bool train_over = admission.max_train_inflight > 0 && train_inflight > admission.max_train_inflight;
+    bool shard_over = false;
+    if (admission.max_inflight > 0 && num_waiting >= admission.max_inflight &&
+        !(waiting[inter_idx].empty() && available[inter_idx] > 0)) {
+        shard_over = true;
+        for (int r = 0; r < (int)available.size() && shard_over; ++r) {
+            if (allocation[train_idx][r]) shard_over = false;
+        }
+    }
+    if (!train_over && !shard_over) return true;
+
+    send_reply(msg.train_id, "busy", msg.intersection, admission.retry_after_ms);
+    if (stats) {
+        stat_add(stats->busy);
+        if (msg.train_id <= MAX_STAT_TRAINS) stat_add(stats->trains[train_idx].busy);
+    }
+    logger.log_server("Train" + std::to_string(msg.train_id) + " busy for " + msg.intersection + " (" +
+                      (train_over ? std::to_string(train_inflight) + " acquires from it"
+                                  : std::to_string(num_waiting) + " waiting") + ")");
+    return false;
+}
+
+static void apply_acquire(const TrainMessage& msg, Logger& logger) {
+    std::string inter = msg.intersection;
+    int train_idx = msg.train_id - 1;
+    int inter_idx = find_intersection_index(inter, shm);
+    if (inter_idx == -1 || inter_idx >= (int)available.size() || !owned(inter_idx)) {
+        logger.log_server("Unknown intersection " + inter + " from Train" + std::to_string(msg.train_id) +
+                          " on shard " + std::to_string(my_shard));
+        route_pos[train_idx]++;
+        send_reply(msg.train_id, "denied", inter);
+        return;
+    }
+    if (shm->intersections[inter_idx].capacity == 0) {
+        // Retired by a reload; releases from its last holders still go through
+        logger.log_server("Train" + std::to_string(msg.train_id) + " denied retired " + inter);
+        route_pos[train_idx]++;
+        send_reply(msg.train_id, "denied", inter);
+        return;
+    }
+    if (strcmp(msg.command, "resume") == 0 && waiting_on[train_idx] == inter_idx) {
+        // A resumed train still queued from the checkpoint: it keeps its place
+        logger.log_server("Train" + std::to_string(msg.train_id) + " reconnected, still waiting for " + inter);
+        return;
+    }
+    if (!admit(msg, inter_idx, logger)) return;
+    handle_acquire(msg.train_id, inter_idx, logger);
+}
+
+// Applies everything one receive drained. Releases go first, so the slots they free are
+// granted (to the trains already queued, then to this batch's acquires in arrival order)
+// before detection runs once for the whole batch; replies wait for the caller's flush.
+// Returns true if the batch held a shutdown.
+static bool process_batch(const std::vector<TrainMessage>& batch, Logger& logger) {
+    bool shutdown = false;
+    std::vector<int> trains;
+    long start = cpu_ns();
+    long trace_start = profiler_now_us();
+    overhead.batches++;
+    if ((long)batch.size() > overhead.max_batch) overhead.max_batch = batch.size();
+
+    for (const TrainMessage& msg : batch) {
+        if (strcmp(msg.command, "shutdown") == 0) {
+            logger.log_server("Shutdown command received. Exiting server.");
+            shutdown = true;
+            continue;
+        }
+        if (strcmp(msg.command, "reload") == 0) {
+            logger.log_server("Reload command received");
+            start_reload(logger);
+            continue;
+        }
+        logger.log_server("Received request from Train" + std::to_string(msg.train_id) + ": " + msg.command);
+        int train_idx = request_train(msg, logger);
+        if (train_idx < 0) continue;
+        overhead.requests++;
+        if (stats) stat_add(stats->requests);
+        detection_policy.requests_since_check++;
+        if (is_acquire(msg)) batch_acquires[train_idx]++;
+        trains.push_back(train_idx);
+        if (strcmp(msg.command, "release") == 0 || strcmp(msg.command, "advance") == 0) {
+            apply_release(msg, logger);
+        }
+    }
+    for (const TrainMessage& msg : batch) {
+        int train_idx = msg.train_id - 1;
+        if (is_acquire(msg) && train_idx >= 0 && train_idx < (int)allocation.size()) {
+            apply_acquire(msg, logger);
+        }
+    }
+    for (int t : trains) batch_acquires[t] = 0;
+    overhead.grant_cpu_ns += cpu_ns() - start;
+
+    maybe_detect(trains, logger);
+    if (trace_enabled()) {
+        trace_slice(getpid(), my_shard, "batch", "server", trace_start, profiler_now_us() - trace_start,
+                    "\"requests\":" + std::to_string(batch.size()));
+    }
+    return shutdown;
+}
+
+void run_server(Logger& logger, const TransportConfig& transport_config, int shard, const Checkpoint* resume) {
+    transport = open_server_transport(transport_config, shard);
+    my_shard = shard;
+    num_shards = transport_config.num_shards;
+    int num_trains = allocation.size();
+    int num_resources = available.size();
+
+    inter_names.clear();
+    for (int r = 0; r < num_resources; ++r) inter_names.push_back(shm->intersections[r].name);
+    resize_deferred.assign(num_resources, false);
+    waiting.assign(num_resources, std::deque<WaitingTrain>());
+    waiting_on.assign(num_trains, -1);
+    waiting_since.assign(num_trains, 0);
+    batch_acquires.assign(num_trains, 0);
+    num_waiting = 0;
+    profiler = new ContentionProfiler(num_trains, num_resources);
+    route_pos.assign(num_trains, 0);
+    route_done.assign(num_trains, false);
+    if (resume) {
+        restore_checkpoint(*resume, logger);
+    }
+    last_checkpoint_ms = now_ms();
+    last_component_rebuild_ms = now_ms();
+    detection_ran(detection_policy, now_ms(), sim_now());
+    if (watch_intersections) {
+        watch_intersections_file(logger);
+    }
+    if (detection_policy.threads > 1) {
+        // Workers inherit a blocked SIGALRM and SIGIO so ticks and file events always land on
+        // (and interrupt) this thread
+        sigset_t alarm_set;
+        sigemptyset(&alarm_set);
+        sigaddset(&alarm_set, SIGALRM);
+        sigaddset(&alarm_set, SIGIO);
+        pthread_sigmask(SIG_BLOCK, &alarm_set, nullptr);
+        detect_pool = new ThreadPool(detection_policy.threads);
+        pthread_sigmask(SIG_UNBLOCK, &alarm_set, nullptr);
+    }
+
+    long tick = detection_tick_ms(detection_policy);
+    if (num_shards > 1 && (tick == 0 || tick > SHARD_TICK_MS)) {
+        tick = SHARD_TICK_MS;
+    }
+    if (!checkpoint_path.empty() && (tick == 0 || tick > checkpoint_interval_ms)) {
+        tick = checkpoint_interval_ms; // Idle servers still checkpoint
+    }
+    if (tick > 0) {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = on_tick;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = 0; // No SA_RESTART, so a tick interrupts the receive
+        sigaction(SIGALRM, &sa, nullptr);
+
+        itimerval timer;
+        timer.it_interval.tv_sec = tick / 1000;
+        timer.it_interval.tv_usec = (tick % 1000) * 1000;
+        timer.it_value = timer.it_interval;
+        setitimer(ITIMER_REAL, &timer, nullptr);
+    }
+    if (trace_enabled()) {
+        trace_process_name(getpid(), "Server shard " + std::to_string(shard));
+        trace_thread_name(getpid(), shard, "requests");
+        if (shard == 0) {
+            for (int t = 0; t < num_trains; ++t) trace_thread_name(TRACE_TRAINS_PID, t + 1, "Train" + std::to_string(t + 1));
+        }
+    }
+    logger.log_server("Deadlock detection policy: " + describe_detection_policy(detection_policy));
+    if (admission.max_inflight > 0 || admission.max_train_inflight > 0) {
+        logger.log_server("Admission control: " + std::to_string(admission.max_inflight) + " waiting per shard, " +
+                          std::to_string(admission.max_train_inflight) + " acquires per train, retry after " +
+                          std::to_string(admission.retry_after_ms) + " ms (0 is unbounded)");
+    }
+    logger.log_server("Shard " + std::to_string(shard) + " listening on " + describe_transport(transport_config));
+
+    TrainMessage msg;
+    std::vector<TrainMessage> batch;
+    bool shutdown = false;
+    while (!shutdown) {
+        // While a reload is being applied, poll so changes keep going in between requests
+        int received = transport->receive(msg, pending_changes.empty());
+        if (stats) stat_set(stats->heartbeat_ms, stats_now_ms());
+        if (stats && received == 1) {
+            // Measured before draining: what had piled up while the last batch was applied
+            long depth = transport->queue_depth() + 1;
+            stat_set(stats->queue_depth, depth);
+            stat_max(stats->max_queue_depth, depth);
+        }
+        // Whatever else is already queued joins the batch without blocking
+        batch.clear();
+        while (received == 1) {
+            batch.push_back(msg);
+            if (batch.size() >= SERVER_BATCH_MAX) break;
+            received = transport->receive(msg, false);
+        }
+        if (received < 0) {
+            break;
+        }
+        maybe_checkpoint(logger);
+        if (file_event && intersections_file_written()) {
+            start_reload(logger);
+        }
+        if (!pending_changes.empty()) {
+            IntersectionChange change = pending_changes.front();
+            pending_changes.pop_front();
+            apply_change(change, logger);
+        }
+        if (batch.empty()) {
+            maybe_detect({}, logger);
+            if (num_shards > 1) expire_cross_shard_waits(logger);
+            continue;
+        }
+        shutdown = process_batch(batch, logger);
+        transport->flush();
+    }
+
+    if (tick > 0) {
+        itimerval off;
+        memset(&off, 0, sizeof(off));
+        setitimer(ITIMER_REAL, &off, nullptr);
+    }
+    if (inotify_fd >= 0) {
+        close(inotify_fd);
+        inotify_fd = -1;
+    }
+    if (checkpoint_pid != -1) waitpid(checkpoint_pid, nullptr, 0); // Let the last checkpoint finish
+    overhead.max_component_trains = std::max<long>(overhead.max_component_trains, components->largest_trains);
+    report_detection_overhead(detection_policy, overhead, logger);
+    if (stats) {
+        // Shards share the segment, so keep the worst shard's p99
+        stat_max(stats->p99_wait_us, profiler->p99_wait_us());
+        stat_set(stats->running, 0);
+    }
+
+    std::string report_path = contention_report_path;
+    if (num_shards > 1) report_path += ".shard" + std::to_string(shard);
+    if (profiler->write_report(report_path, shm, profiler_now_us())) {
+        logger.log_server("Contention report written to " + report_path);
+    } else {
+        std::cerr << "Error: Could not write contention report " << report_path << std::endl;
+    }
+    delete profiler;
+    profiler = nullptr;
+    delete detect_pool;
+    detect_pool = nullptr;
+    delete transport;
+    transport = nullptr;
+}
@@ -0,0 +1,51 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Declares the server process and the simulation state it shares with main.
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <vector>
+#include <string>
+#include <pthread.h>
+#include "sync.h"
+#include "log.h"
+#include "components.h"
+#include "detection_policy.h"
+#include "stats.h"
+#include "transport.h"
+#include "checkpoint.h"
+
+// Admission control for acquires that would have to queue. 0 leaves a budget unbounded.
+struct AdmissionConfig {
+    int max_inflight = 0;       // trains waiting on one shard
+    int max_train_inflight = 0; // acquires one train has outstanding on a shard; releases never count
+    int retry_after_ms = 20;    // hint sent with BUSY; trains add their own backoff on top
+};
+
+// Globals owned by main.cpp
+extern SharedMemory* shm;
+extern int* sim_time;
+extern pthread_mutex_t* time_mutex;
+
+extern std::vector<std::vector<int>> allocation;
+extern std::vector<std::vector<int>> request;
+extern std::vector<int> available;
+extern ResourceComponents* components;
+extern DetectionPolicy detection_policy;
+extern SimStats* stats;
+extern std::string contention_report_path;
+extern std::string checkpoint_path;   // empty disables checkpoints
+extern long checkpoint_interval_ms;
+extern std::string intersections_path; // re-read on a "reload" command
+extern bool watch_intersections;       // also reload whenever intersections_path is written
+extern AdmissionConfig admission;
+
+// Server process for one shard: grants the intersections that shard owns, queues waiting
+// trains and runs deadlock detection. resume, if given, is restored before the first request.
+// Capacity changes, new and retired intersections from a reload are applied one per request.
+// Returns when a shutdown message is received.
+void run_server(Logger& logger, const TransportConfig& transport_config, int shard, const Checkpoint* resume);
+
+#endif // SERVER_H
@@ -0,0 +1,163 @@
+// Group : I
+// Author: Samuel Shankle
+// Email: samuel.shankle@okstate.edu
+// Date: 10/19/2026
+// Description: Standalone viewer for a running simulation. Attaches to the stats segment read-only and prints a
+// refreshing top-like view. Usage: ./simstat [refresh_ms] [--once] [--run=ID] [--holders]
+// Without --run it follows TRAINSIM_RUN_ID, or else the most recently started simulation. --holders also maps the
+// intersection table read-only and lists which trains hold each intersection, from a seqlock snapshot.
+
+#include "stats.h"
+#include "run_ipc.h"
+#include "sync.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/mman.h>
+
+static const char* state_name(int state) {
+    switch (state) {
+        case TRAIN_STARTING:   return "starting";
+        case TRAIN_WAITING:    return "waiting";
+        case TRAIN_TRAVERSING: return "moving";
+        case TRAIN_DONE:       return "done";
+    }
+    return "?";
+}
+
+static long load(const std::atomic<long>& v) { return v.load(std::memory_order_relaxed); }
+static int load(const std::atomic<int>& v) { return v.load(std::memory_order_relaxed); }
+
+int main(int argc, char* argv[]) {
+    int refresh_ms = 1000;
+    bool once = false;
+    bool holders = false;
+    std::string run_id = getenv(RUN_ID_ENV) ? getenv(RUN_ID_ENV) : "";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--once") {
+            once = true;
+        } else if (arg == "--holders") {
+            holders = true;
+        } else if (arg.rfind("--run=", 0) == 0) {
+            run_id = arg.substr(6);
+        } else {
+            refresh_ms = atoi(argv[i]);
+            if (refresh_ms <= 0) {
+                std::cerr << "Usage: " << argv[0] << " [refresh_ms] [--once] [--run=ID] [--holders]\n";
+                return 1;
+            }
+        }
+    }
+
+    if (run_id.empty()) run_id = latest_run_id();
+    const SimStats* stats = run_id.empty() ? nullptr : attach_stats(run_id);
+    if (!stats) {
+        std::cerr << "simstat: no simulation stats segment found for run '" << run_id << "' (is ./main running?)\n";
+        return 1;
+    }
+
+    // Never locked from here: the server's writes do not wait for this view
+    const SharedMemory* table = nullptr;
+    TableSnapshot snapshot;
+    if (holders) {
+        table = (const SharedMemory*)attach_segment(run_id, "intersections", sizeof(SharedMemory), true);
+        if (!table) {
+            std::cerr << "simstat: no intersection table found for run '" << run_id << "'\n";
+            return 1;
+        }
+    }
+
+    int t = stats->num_trains;
+    std::vector<long> last_grants;
+    long last_total = load(stats->grants);
+    long last_ms = stats_now_ms();
+
+    while (true) {
+        long now = stats_now_ms();
+        double elapsed = (now - last_ms) / 1000.0;
+        long total = load(stats->grants);
+        // Re-read every refresh: a reload can add intersections while simstat is attached
+        int n = load(stats->num_intersections);
+        if ((int)last_grants.size() < n) last_grants.resize(n, 0);
+        double rate = elapsed > 0 ? (total - last_total) / elapsed : 0.0;
+
+        if (!once) std::cout << "\033[H\033[2J";
+        std::cout << "simstat  uptime " << (now - load(stats->start_ms)) / 1000 << "s"
+                  << "  server " << (load(stats->running) ? "running" : "stopped")
+                  << " (heartbeat " << now - load(stats->heartbeat_ms) << " ms ago)\n";
+        std::cout << "requests " << load(stats->requests) << "  grants " << total
+                  << "  waits " << load(stats->waits) << "  deadlocks " << load(stats->deadlocks)
+                  << "  recoveries " << load(stats->recoveries)
+                  << "  grants/s " << std::fixed << std::setprecision(1) << rate << "\n";
+        std::cout << "queue depth " << load(stats->queue_depth) << " (max " << load(stats->max_queue_depth) << ")"
+                  << "  busy " << load(stats->busy) << "\n\n";
+
+        std::cout << std::left << std::setw(24) << "INTERSECTION" << std::right
+                  << std::setw(8) << "OCC" << std::setw(6) << "CAP" << std::setw(8) << "QUEUE"
+                  << std::setw(10) << "GRANTS" << std::setw(10) << "WAITS" << std::setw(10) << "GRANT/s" << "\n";
+        for (int i = 0; i < n; ++i) {
+            const IntersectionStats& s = stats->intersections[i];
+            if (!s.ready.load(std::memory_order_acquire)) continue; // another shard is still filling it in
+            long grants = load(s.grants);
+            double inter_rate = elapsed > 0 ? (grants - last_grants[i]) / elapsed : 0.0;
+            last_grants[i] = grants;
+            std::cout << std::left << std::setw(24) << s.name << std::right
+                      << std::setw(8) << load(s.occupancy) << std::setw(6) << load(s.capacity)
+                      << std::setw(8) << load(s.queue_depth) << std::setw(10) << grants
+                      << std::setw(10) << load(s.waits) << std::setw(10) << inter_rate << "\n";
+        }
+
+        if (table) {
+            int retries = snapshot_intersections(table, snapshot);
+            std::cout << "\nHOLDERS (table version " << snapshot.version << ", " << retries << " retries)\n";
+            for (int i = 0; i < n && i < MAX_INTERSECTIONS; ++i) {
+                const IntersectionSnapshot& s = snapshot.intersections[i];
+                std::cout << std::left << std::setw(24) << s.name << std::right << std::setw(4) << s.num_holding_trains
+                          << "/" << std::left << std::setw(4) << s.capacity;
+                for (int h = 0; h < s.num_holding_trains && h < MAX_TRAINS_AT_INTERSECTION; ++h) {
+                    std::cout << " Train" << s.holding_trains[h];
+                }
+                std::cout << "\n";
+            }
+        }
+
+        int by_state[4] = {0, 0, 0, 0};
+        for (int i = 0; i < t; ++i) {
+            int state = load(stats->trains[i].state);
+            if (state >= 0 && state < 4) by_state[state]++;
+        }
+        std::cout << "\ntrains " << t;
+        for (int s = 0; s < 4; ++s) {
+            std::cout << "  " << state_name(s) << " " << by_state[s];
+        }
+        std::cout << "\n";
+
+        std::cout << "\n" << std::left << std::setw(10) << "TRAIN" << std::right << std::setw(10) << "STATE"
+                  << std::setw(10) << "REQS" << std::setw(10) << "GRANTS" << std::setw(12) << "WAIT ms"
+                  << std::setw(10) << "RESTARTS" << std::setw(8) << "BUSY" << std::setw(10) << "FULL"
+                  << std::left << "\n";
+        for (int i = 0; i < t && i < 20; ++i) {
+            const TrainStats& s = stats->trains[i];
+            std::cout << std::left << std::setw(10) << ("Train" + std::to_string(i + 1)) << std::right
+                      << std::setw(10) << state_name(load(s.state)) << std::setw(10) << load(s.requests)
+                      << std::setw(10) << load(s.grants) << std::setw(12) << load(s.wait_ms)
+                      << std::setw(10) << load(s.restarts) << std::setw(8) << load(s.busy)
+                      << std::setw(10) << load(s.send_retries) << "\n";
+        }
+        if (t > 20) std::cout << "... " << t - 20 << " more\n";
+        std::cout << std::flush;
+
+        if (once) break;
+        last_total = total;
+        last_ms = now;
+        usleep(refresh_ms * 1000);
+    }
+
+    if (table) munmap((void*)table, sizeof(SharedMemory));
+    detach_stats(stats);
+    return 0;
+}
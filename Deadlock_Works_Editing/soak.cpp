@@ -0,0 +1,533 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Soak harness. It generates a pool of random networks and train mixes, then until the duration is up
+// runs ./main on them in turn and watches each run's stats segment, checking three invariants on every sample:
+//   capacity   no intersection is held by more trains than its capacity
+//   free       no train stays queued for an intersection that has free capacity (a lost grant)
+//   answer     every request is answered: a train never keeps waiting once the servers have replied to all of its
+//              requests (a lost reply), no train waits longer than --answer-timeout, and the run never goes
+//              --stall-timeout without a grant while trains are waiting
+// A run that breaks one, or is still going after --run-timeout (trains granted and aborted forever without finishing,
+// i.e. a livelock), is killed and its directory kept. Grants per second and finished trains are recorded over the
+// whole soak in timeline.csv. Because every scenario is run again and again, throughput is compared like for like:
+// the soak fails if runs in its last third are slower than the same scenarios' runs in its first third by more than
+// --max-decay percent.
+// Usage: ./soak [--main=PATH] [--out=DIR] [--duration=S] [--seed=N] [--scenarios=N] [--trains=MIN-MAX]
+//               [--intersections=MIN-MAX] [--movement=hop,pipelined] [--sample-ms=MS] [--answer-timeout=S] [--stall-timeout=S]
+//               [--run-timeout=S] [--max-decay=PCT] [--keep] [-- ARGS...]
+// ARGS are passed to every run, e.g. -- --transport=unix:/tmp/soak.sock --shards=2
+
+#include "stats.h"
+#include "run_ipc.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <csignal>
+#include <ctime>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+// A queue with free capacity can be seen for a moment between a release and the grant it triggers,
+// and a sent reply for a moment before the train reads it
+#define FREE_CAPACITY_GRACE_MS 1000
+#define LOST_REPLY_GRACE_MS 1000
+#define ATTACH_TIMEOUT_MS 10000
+
+struct SoakOptions {
+    std::string main_path = "./main";
+    std::string out_dir = "soak_out";
+    long duration_s = 300;
+    unsigned seed = 1;
+    int scenarios = 8;
+    int min_trains = 20, max_trains = 200;
+    int min_intersections = 5, max_intersections = 30;
+    long sample_ms = 50;
+    long answer_timeout_s = 300; // hold-all trains can legitimately queue behind a congested route for a long time
+    long stall_timeout_s = 15;
+    long run_timeout_s = 300;
+    std::vector<std::string> movements = {"hop", "pipelined"}; // hold-all livelocks at these densities, opt in
+    double max_decay_pct = 25;
+    bool keep = false;
+    std::vector<std::string> args;
+};
+
+struct Scenario {
+    int index;
+    std::string dir; // absolute, holds its intersections.txt and trains.txt
+    int trains;
+    int intersections;
+    std::string movement;
+    long traverse_ms;
+};
+
+struct RunOutcome {
+    int scenario;
+    std::string status = "ok"; // ok, failed, timeout or the invariant that broke
+    std::string detail;
+    long wall_ms = 0;
+    long grants = 0;
+    long deadlocks = 0;
+    long max_wait_ms = 0;
+    int done = 0;
+};
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void on_interrupt(int) {
+    interrupted = 1;
+}
+
+static long now_ms() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static std::string absolute(const std::string& path) {
+    char resolved[PATH_MAX];
+    return realpath(path.c_str(), resolved) ? resolved : path;
+}
+
+static bool parse_range(const std::string& value, int& lo, int& hi) {
+    if (sscanf(value.c_str(), "%d-%d", &lo, &hi) == 2) return lo >= 1 && lo <= hi;
+    if (sscanf(value.c_str(), "%d", &lo) == 1) {
+        hi = lo;
+        return lo >= 1;
+    }
+    return false;
+}
+
+// Mostly single-track mutexes with some wider junctions; every route visits distinct intersections
+static bool write_scenario(const Scenario& s, std::mt19937& rng, const std::string& dir) {
+    std::ofstream inters(dir + "/intersections.txt");
+    std::ofstream trains(dir + "/trains.txt");
+    if (!inters.is_open() || !trains.is_open()) return false;
+
+    inters << "#INTERSECTIONS\n";
+    for (int i = 0; i < s.intersections; ++i) {
+        int capacity = rng() % 3 == 0 ? 2 + rng() % 2 : 1;
+        inters << "Intersection" << i + 1 << ":" << capacity << "\n";
+    }
+
+    std::vector<int> order(s.intersections);
+    for (int i = 0; i < s.intersections; ++i) order[i] = i + 1;
+    trains << "#TRAINS\n";
+    for (int t = 0; t < s.trains; ++t) {
+        std::shuffle(order.begin(), order.end(), rng);
+        int hops = std::min(s.intersections, 2 + (int)(rng() % 5));
+        trains << "Train" << t + 1 << ":";
+        for (int h = 0; h < hops; ++h) trains << (h ? "," : "") << "Intersection" << order[h];
+        trains << "\n";
+    }
+    return (bool)inters && (bool)trains;
+}
+
+static std::string run_dir(const SoakOptions& opt, int run) {
+    return opt.out_dir + "/run_" + std::to_string(run);
+}
+
+static pid_t launch(const SoakOptions& opt, const Scenario& s, int run, const std::string& run_id) {
+    std::vector<std::string> args = {opt.main_path, "--intersections=" + s.dir + "/intersections.txt",
+                                     "--trains=" + s.dir + "/trains.txt", "--metrics=metrics.txt",
+                                     "--movement=" + s.movement, "--traverse-ms=" + std::to_string(s.traverse_ms),
+                                     "--run-id=" + run_id};
+    args.insert(args.end(), opt.args.begin(), opt.args.end());
+
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    // Own process group, so a broken run can be killed with every train it forked
+    setpgid(0, 0);
+    if (chdir(run_dir(opt, run).c_str()) != 0) _exit(127);
+    int fd = open("output.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+    }
+
+    std::vector<char*> argv;
+    for (std::string& a : args) argv.push_back(&a[0]);
+    argv.push_back(nullptr);
+    execv(opt.main_path.c_str(), argv.data());
+    perror("execv");
+    _exit(127);
+}
+
+static long load(const std::atomic<long>& v) { return v.load(std::memory_order_relaxed); }
+static int load(const std::atomic<int>& v) { return v.load(std::memory_order_relaxed); }
+
+// Per-train view of the current wait: it is the same request for as long as the counters do not move
+struct TrainWatch {
+    long key = -1;
+    long since_ms = 0;
+    long answered_ms = -1; // since when the servers have replied to every request, -1 while one is outstanding
+};
+
+class RunWatcher {
+public:
+    RunWatcher(const SoakOptions& opt, std::ofstream& timeline, long soak_start_ms, int run)
+        : opt(opt), timeline(timeline), soak_start_ms(soak_start_ms), run(run) {}
+
+    // Returns false with outcome filled in once an invariant breaks
+    bool sample(const SimStats* stats, RunOutcome& outcome) {
+        long now = now_ms();
+        int waiting = 0, done = 0;
+        for (int t = 0; t < stats->num_trains && t < MAX_STAT_TRAINS; ++t) {
+            const TrainStats& ts = stats->trains[t];
+            if (trains.size() <= (size_t)t) trains.resize(t + 1);
+            done += load(ts.state) == TRAIN_DONE;
+            if (load(ts.state) != TRAIN_WAITING) {
+                trains[t].key = -1;
+                trains[t].answered_ms = -1;
+                continue;
+            }
+            waiting++;
+            long requests = load(ts.requests);
+            long key = requests + load(ts.grants) + load(ts.restarts);
+            if (trains[t].key != key) {
+                trains[t].key = key;
+                trains[t].since_ms = now;
+                trains[t].answered_ms = -1;
+            }
+            if (load(ts.replies) < requests) {
+                trains[t].answered_ms = -1;
+            } else if (trains[t].answered_ms < 0) {
+                trains[t].answered_ms = now;
+            } else if (now - trains[t].answered_ms > LOST_REPLY_GRACE_MS) {
+                return fail(outcome, "answer", "Train" + std::to_string(t + 1) + " is still waiting " +
+                                                   std::to_string(now - trains[t].answered_ms) +
+                                                   " ms after its reply was sent (lost reply)");
+            }
+            long waited = now - trains[t].since_ms;
+            outcome.max_wait_ms = std::max(outcome.max_wait_ms, waited);
+            if (waited > opt.answer_timeout_s * 1000) {
+                return fail(outcome, "answer", "Train" + std::to_string(t + 1) + " has had no reply for " +
+                                                   std::to_string(waited) + " ms");
+            }
+        }
+
+        int num_intersections = load(stats->num_intersections);
+        if (free_since.size() < (size_t)num_intersections) free_since.assign(num_intersections, -1);
+        for (int i = 0; i < num_intersections && i < MAX_INTERSECTIONS; ++i) {
+            const IntersectionStats& is = stats->intersections[i];
+            if (!is.ready.load(std::memory_order_acquire)) continue; // another shard is still filling it in
+            int capacity = load(is.capacity), occupancy = load(is.occupancy), queued = load(is.queue_depth);
+            if (capacity <= 0) continue; // retired by a reload
+            if (occupancy > capacity) {
+                return fail(outcome, "capacity", std::string(is.name) + " held by " + std::to_string(occupancy) +
+                                                     " trains, capacity " + std::to_string(capacity));
+            }
+            if (queued > 0 && occupancy < capacity) {
+                if (free_since[i] < 0) free_since[i] = now;
+                if (now - free_since[i] > FREE_CAPACITY_GRACE_MS) {
+                    return fail(outcome, "free", std::string(is.name) + " has " + std::to_string(queued) +
+                                                     " queued with " + std::to_string(capacity - occupancy) +
+                                                     " free for " + std::to_string(now - free_since[i]) + " ms");
+                }
+            } else {
+                free_since[i] = -1;
+            }
+        }
+
+        long grants = load(stats->grants);
+        if (grants != last_grants || waiting == 0) {
+            last_grants = grants;
+            last_progress_ms = now;
+        } else if (now - last_progress_ms > opt.stall_timeout_s * 1000) {
+            return fail(outcome, "answer", "no grant for " + std::to_string(now - last_progress_ms) + " ms with " +
+                                               std::to_string(waiting) + " trains waiting");
+        }
+        outcome.grants = grants;
+        outcome.deadlocks = load(stats->deadlocks);
+        outcome.done = done;
+
+        if (now - window_start_ms >= 1000) {
+            timeline << now - soak_start_ms << "," << run << "," << grants << "," << waiting << "," << done << ","
+                     << std::fixed << std::setprecision(1) << (grants - window_grants) * 1000.0 / (now - window_start_ms)
+                     << "\n";
+            window_start_ms = now;
+            window_grants = grants;
+        }
+        return true;
+    }
+
+private:
+    const SoakOptions& opt;
+    std::ofstream& timeline;
+    long soak_start_ms;
+    int run;
+    std::vector<TrainWatch> trains;
+    std::vector<long> free_since; // when each intersection was first seen with waiters and free capacity
+    long last_grants = -1;
+    long last_progress_ms = now_ms();
+    long window_start_ms = now_ms();
+    long window_grants = 0;
+
+    static bool fail(RunOutcome& outcome, const std::string& status, const std::string& detail) {
+        outcome.status = status;
+        outcome.detail = detail;
+        return false;
+    }
+};
+
+static RunOutcome run_one(const SoakOptions& opt, const Scenario& s, int run, std::ofstream& timeline,
+                          long soak_start_ms) {
+    RunOutcome outcome;
+    outcome.scenario = s.index;
+    std::string run_id = "soak" + std::to_string(getpid()) + "-" + std::to_string(run);
+    long start = now_ms();
+    pid_t pid = launch(opt, s, run, run_id);
+    if (pid < 0) {
+        outcome.status = "failed";
+        outcome.detail = "fork failed";
+        return outcome;
+    }
+
+    RunWatcher watcher(opt, timeline, soak_start_ms, run);
+    const SimStats* stats = nullptr;
+    int status = 0;
+    bool exited = false;
+    while (!interrupted) {
+        if (waitpid(pid, &status, WNOHANG) == pid) {
+            exited = true;
+            break;
+        }
+        if (!stats) {
+            // The segment appears once main has parsed its input
+            stats = attach_stats(run_id);
+            if (!stats && now_ms() - start > ATTACH_TIMEOUT_MS) {
+                outcome.status = "failed";
+                outcome.detail = "no stats segment after " + std::to_string(ATTACH_TIMEOUT_MS) + " ms";
+                break;
+            }
+        }
+        if (stats && !watcher.sample(stats, outcome)) break;
+        if (now_ms() - start > opt.run_timeout_s * 1000) {
+            outcome.status = "timeout";
+            outcome.detail = std::to_string(outcome.done) + " of " + std::to_string(s.trains) + " trains done";
+            break;
+        }
+        usleep(opt.sample_ms * 1000);
+    }
+    outcome.wall_ms = now_ms() - start;
+
+    if (!exited) {
+        // SIGTERM first: main removes its segments and message queue on the way out
+        kill(pid, SIGTERM);
+        for (int i = 0; i < 20 && waitpid(pid, &status, WNOHANG) != pid; ++i) usleep(50000);
+        kill(-pid, SIGKILL);
+        waitpid(pid, &status, 0);
+        if (interrupted && outcome.status == "ok") {
+            outcome.status = "failed";
+            outcome.detail = "interrupted";
+        }
+    } else {
+        kill(-pid, SIGKILL); // Any train the run left behind
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            outcome.status = "failed";
+            outcome.detail = WIFEXITED(status) ? "exit status " + std::to_string(WEXITSTATUS(status))
+                                               : "signal " + std::to_string(WTERMSIG(status));
+        }
+    }
+    if (stats) {
+        // Still mapped after main unlinked it, so the final counts are readable
+        outcome.grants = load(stats->grants);
+        outcome.deadlocks = load(stats->deadlocks);
+        outcome.done = 0;
+        for (int t = 0; t < stats->num_trains; ++t) outcome.done += load(stats->trains[t].state) == TRAIN_DONE;
+        detach_stats(stats);
+    }
+    // Whatever a killed run could not remove itself; named run IDs are never cleaned up as stale
+    remove_run_segments(run_id);
+    return outcome;
+}
+
+static double throughput(const RunOutcome& run) {
+    return run.wall_ms > 0 ? run.grants * 1000.0 / run.wall_ms : 0;
+}
+
+// Geometric mean over scenarios of (late throughput / early throughput), each the scenario's mean over the runs
+// in the first and last third of the soak. Returns false if no scenario ran in both.
+static bool throughput_ratio(const std::vector<RunOutcome>& runs, int scenarios, double& ratio, int& compared) {
+    size_t third = runs.size() / 3;
+    std::vector<double> early(scenarios, 0), late(scenarios, 0);
+    std::vector<int> early_n(scenarios, 0), late_n(scenarios, 0);
+    for (size_t i = 0; i < third; ++i) {
+        early[runs[i].scenario] += throughput(runs[i]);
+        early_n[runs[i].scenario]++;
+    }
+    for (size_t i = runs.size() - third; i < runs.size(); ++i) {
+        late[runs[i].scenario] += throughput(runs[i]);
+        late_n[runs[i].scenario]++;
+    }
+    double log_sum = 0;
+    compared = 0;
+    for (int k = 0; k < scenarios; ++k) {
+        if (early_n[k] == 0 || late_n[k] == 0 || early[k] <= 0 || late[k] <= 0) continue;
+        log_sum += std::log((late[k] / late_n[k]) / (early[k] / early_n[k]));
+        compared++;
+    }
+    ratio = compared > 0 ? std::exp(log_sum / compared) : 1;
+    return compared > 0;
+}
+
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [--main=PATH] [--out=DIR] [--duration=S] [--seed=N] [--scenarios=N] [--trains=MIN-MAX]\n"
+              << "       [--intersections=MIN-MAX] [--movement=hold-all,hop,pipelined] [--sample-ms=MS]\n"
+              << "       [--answer-timeout=S] [--stall-timeout=S] [--run-timeout=S] [--max-decay=PCT] [--keep] [-- ARGS...]\n";
+}
+
+int main(int argc, char* argv[]) {
+    SoakOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--") {
+            opt.args.assign(argv + i + 1, argv + argc);
+            break;
+        } else if (arg.rfind("--main=", 0) == 0) {
+            opt.main_path = arg.substr(7);
+        } else if (arg.rfind("--out=", 0) == 0) {
+            opt.out_dir = arg.substr(6);
+        } else if (arg.rfind("--duration=", 0) == 0) {
+            opt.duration_s = atol(arg.c_str() + 11);
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            opt.seed = strtoul(arg.c_str() + 7, nullptr, 10);
+        } else if (arg.rfind("--scenarios=", 0) == 0) {
+            opt.scenarios = std::max(1, atoi(arg.c_str() + 12));
+        } else if (arg.rfind("--trains=", 0) == 0) {
+            if (!parse_range(arg.substr(9), opt.min_trains, opt.max_trains) || opt.max_trains > MAX_STAT_TRAINS) {
+                std::cerr << "Error: Bad train range " << arg.substr(9) << " (at most " << MAX_STAT_TRAINS << ")\n";
+                return 1;
+            }
+        } else if (arg.rfind("--intersections=", 0) == 0) {
+            if (!parse_range(arg.substr(16), opt.min_intersections, opt.max_intersections) ||
+                opt.min_intersections < 2 || opt.max_intersections > MAX_INTERSECTIONS) {
+                std::cerr << "Error: Bad intersection range " << arg.substr(16) << " (2 to " << MAX_INTERSECTIONS << ")\n";
+                return 1;
+            }
+        } else if (arg.rfind("--movement=", 0) == 0) {
+            opt.movements.clear();
+            std::stringstream list(arg.substr(11));
+            std::string mode;
+            while (std::getline(list, mode, ',')) {
+                if (mode != "hold-all" && mode != "hop" && mode != "pipelined") {
+                    std::cerr << "Error: Bad movement " << mode << " (use hold-all, hop or pipelined)\n";
+                    return 1;
+                }
+                opt.movements.push_back(mode);
+            }
+            if (opt.movements.empty()) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--sample-ms=", 0) == 0) {
+            opt.sample_ms = std::max(1L, atol(arg.c_str() + 12));
+        } else if (arg.rfind("--answer-timeout=", 0) == 0) {
+            opt.answer_timeout_s = atol(arg.c_str() + 17);
+        } else if (arg.rfind("--stall-timeout=", 0) == 0) {
+            opt.stall_timeout_s = atol(arg.c_str() + 16);
+        } else if (arg.rfind("--run-timeout=", 0) == 0) {
+            opt.run_timeout_s = atol(arg.c_str() + 14);
+        } else if (arg.rfind("--max-decay=", 0) == 0) {
+            opt.max_decay_pct = atof(arg.c_str() + 12);
+        } else if (arg == "--keep") {
+            opt.keep = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    opt.main_path = absolute(opt.main_path);
+    if (access(opt.main_path.c_str(), X_OK) != 0) {
+        std::cerr << "Error: " << opt.main_path << " is not executable\n";
+        return 1;
+    }
+    mkdir(opt.out_dir.c_str(), 0755);
+    std::ofstream timeline(opt.out_dir + "/timeline.csv");
+    if (!timeline.is_open()) {
+        std::cerr << "Error: Could not write " << opt.out_dir << "/timeline.csv\n";
+        return 1;
+    }
+    timeline << "elapsed_ms,run,grants,waiting,done,grants_per_sec\n";
+    signal(SIGINT, on_interrupt);
+    signal(SIGTERM, on_interrupt);
+
+    std::mt19937 rng(opt.seed);
+    std::vector<Scenario> pool;
+    for (int k = 0; k < opt.scenarios; ++k) {
+        Scenario s;
+        s.index = k;
+        s.dir = absolute(opt.out_dir) + "/scenario_" + std::to_string(k);
+        s.trains = opt.min_trains + rng() % (opt.max_trains - opt.min_trains + 1);
+        s.intersections = opt.min_intersections + rng() % (opt.max_intersections - opt.min_intersections + 1);
+        s.movement = opt.movements[rng() % opt.movements.size()];
+        s.traverse_ms = 5 + rng() % 46;
+        mkdir(s.dir.c_str(), 0755);
+        if (!write_scenario(s, rng, s.dir)) {
+            std::cerr << "Error: Could not write the scenario in " << s.dir << "\n";
+            return 1;
+        }
+        pool.push_back(s);
+    }
+
+    std::vector<RunOutcome> runs;
+    int broken = 0;
+    long soak_start = now_ms();
+    std::cout << "Soak: " << opt.duration_s << " s, seed " << opt.seed << ", " << opt.scenarios
+              << " scenarios, output in " << opt.out_dir << "\n";
+
+    while (!interrupted && now_ms() - soak_start < opt.duration_s * 1000) {
+        int run = runs.size();
+        const Scenario& s = pool[run % pool.size()];
+        std::string dir = run_dir(opt, run);
+        mkdir(dir.c_str(), 0755);
+        RunOutcome outcome = run_one(opt, s, run, timeline, soak_start);
+        timeline.flush();
+        if (interrupted) break;
+        runs.push_back(outcome);
+
+        bool ok = outcome.status == "ok";
+        if (!ok) broken++;
+        std::cout << "run_" << run << " scenario_" << s.index << " " << s.trains << " trains, " << s.intersections << " intersections, "
+                  << s.movement << " " << s.traverse_ms << " ms: " << outcome.status << " " << outcome.wall_ms << " ms, "
+                  << outcome.done << "/" << s.trains << " done, " << outcome.grants << " grants, " << outcome.deadlocks << " deadlocks, longest wait "
+                  << outcome.max_wait_ms << " ms" << (outcome.detail.empty() ? "" : " (" + outcome.detail + ")") << "\n";
+        if (ok && !opt.keep) {
+            std::string cleanup = "rm -rf '" + dir + "'";
+            if (system(cleanup.c_str()) != 0) std::cerr << "Warning: Could not remove " << dir << "\n";
+        }
+    }
+
+    double ratio = 1, decay = 0;
+    int compared = 0;
+    bool measured = throughput_ratio(runs, opt.scenarios, ratio, compared);
+    if (measured) decay = 100 * (1 - ratio);
+    std::cout << "\n" << runs.size() << " runs, " << broken << " broken";
+    if (measured) {
+        std::cout << ", throughput of the last third vs the first " << std::showpos << std::fixed << std::setprecision(1)
+                  << -decay << "%" << std::noshowpos << " over " << compared << " scenarios";
+    } else {
+        std::cout << ", too short to compare throughput (every scenario needs a run in the first and last third)";
+    }
+    std::cout << "\n";
+    if (broken > 0) return 1;
+    if (decay > opt.max_decay_pct) {
+        std::cout << "Throughput decayed by more than " << opt.max_decay_pct << "%\n";
+        return 2;
+    }
+    return 0;
+}
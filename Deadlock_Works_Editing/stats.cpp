@@ -0,0 +1,60 @@
+// Group : I
+// Author: Samuel Shankle
+// Email: samuel.shankle@okstate.edu
+// Date: 10/19/2026
+// Description: Creates and attaches the live statistics shared memory segment.
+
+#include "stats.h"
+#include "run_ipc.h"
+#include <ctime>
+#include <sys/mman.h>
+
+long stats_now_ms() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+SimStats* create_stats(const std::string& run_id, SharedMemory* shm, int num_intersections, int num_trains) {
+    void* addr = create_segment(run_id, STATS_SEGMENT, sizeof(SimStats));
+    if (!addr) {
+        std::cerr << "Error: Could not create the stats segment\n";
+        return nullptr;
+    }
+
+    SimStats* stats = (SimStats*)addr;
+    memset((void*)stats, 0, sizeof(SimStats)); // every member is an integer, so zero bytes are valid atomics
+
+    stats->num_intersections.store(num_intersections, std::memory_order_relaxed);
+    stats->num_trains = num_trains < MAX_STAT_TRAINS ? num_trains : MAX_STAT_TRAINS;
+    for (int i = 0; i < num_intersections && i < MAX_INTERSECTIONS; ++i) {
+        strncpy(stats->intersections[i].name, shm->intersections[i].name, MAX_INTERSECTION_NAME_LENGTH);
+        stats->intersections[i].capacity.store(shm->intersections[i].capacity, std::memory_order_relaxed);
+        stats->intersections[i].ready.store(1, std::memory_order_relaxed); // published by the magic below
+    }
+    stats->start_ms.store(stats_now_ms(), std::memory_order_relaxed);
+    stats->heartbeat_ms.store(stats_now_ms(), std::memory_order_relaxed);
+    stats->running.store(1, std::memory_order_relaxed);
+
+    // Release so a reader that sees the magic also sees the names and sizes above
+    stats->magic.store(STATS_MAGIC, std::memory_order_release);
+    return stats;
+}
+
+const SimStats* attach_stats(const std::string& run_id) {
+    void* addr = attach_segment(run_id, STATS_SEGMENT, sizeof(SimStats), true);
+    if (!addr) {
+        return nullptr;
+    }
+
+    const SimStats* stats = (const SimStats*)addr;
+    if (stats->magic.load(std::memory_order_acquire) != STATS_MAGIC) {
+        detach_stats(stats);
+        return nullptr;
+    }
+    return stats;
+}
+
+void detach_stats(const SimStats* stats) {
+    munmap((void*)stats, sizeof(SimStats));
+}
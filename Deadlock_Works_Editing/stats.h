@@ -0,0 +1,111 @@
+// Group : I
+// Author: Samuel Shankle
+// Email: samuel.shankle@okstate.edu
+// Date: 10/19/2026
+// Description: Declares the live statistics segment. The server and trains publish counters with relaxed atomics;
+// observers such as simstat attach read-only and never touch the simulation's locks.
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <string>
+#include "sync.h"
+
+#define STATS_SEGMENT "stats"
+#define STATS_MAGIC 0x53544154 // "STAT"
+#define MAX_STAT_TRAINS 1024
+
+enum TrainState {
+    TRAIN_STARTING = 0,
+    TRAIN_WAITING = 1,    // ACQUIRE sent, no reply yet
+    TRAIN_TRAVERSING = 2,
+    TRAIN_DONE = 3
+};
+
+struct IntersectionStats {
+    std::atomic<int> ready;       // set with release once name is filled in; read it with acquire before name
+    char name[MAX_INTERSECTION_NAME_LENGTH];
+    std::atomic<int> capacity;    // a reload can change it
+    std::atomic<int> occupancy;   // trains holding it now
+    std::atomic<int> queue_depth; // trains waiting for it now
+    std::atomic<long> grants;
+    std::atomic<long> waits;      // acquires that had to queue
+};
+
+struct TrainStats {
+    std::atomic<int> state;
+    std::atomic<long> requests;
+    std::atomic<long> grants;
+    std::atomic<long> wait_ms;    // total time between ACQUIRE and its reply
+    std::atomic<long> restarts;   // times chosen as a deadlock victim
+    std::atomic<long> replies;    // answers the servers sent (granted, denied, abort or busy)
+    std::atomic<long> busy;       // acquires turned away by admission control and sent again
+    std::atomic<long> send_retries; // sends that found the request queue full and backed off
+};
+
+struct SimStats {
+    std::atomic<int> magic;       // STATS_MAGIC once the tables below are filled in
+    std::atomic<int> running;
+    std::atomic<long> start_ms;
+    std::atomic<long> heartbeat_ms; // last time the server loop ran
+    std::atomic<int> num_intersections; // grows when a reload adds an intersection; rows below it may not be ready yet
+    int num_trains;
+
+    std::atomic<long> requests;
+    std::atomic<long> grants;
+    std::atomic<long> waits;
+    std::atomic<long> deadlocks;
+    std::atomic<long> recoveries;
+    std::atomic<long> p99_wait_us;  // request -> grant, published by the server when it shuts down
+    std::atomic<long> busy;         // acquires turned away by admission control
+    std::atomic<long> queue_depth;  // messages queued at the server's last receive
+    std::atomic<long> max_queue_depth;
+
+    IntersectionStats intersections[MAX_INTERSECTIONS];
+    TrainStats trains[MAX_STAT_TRAINS];
+};
+
+static_assert(std::atomic<long>::is_always_lock_free, "stats counters must be lock-free to be shared between processes");
+
+// Creates the run's stats segment and copies names/capacities from shm. Called by main before forking.
+SimStats* create_stats(const std::string& run_id, SharedMemory* shm, int num_intersections, int num_trains);
+
+// Attaches to a run's stats segment read-only. Returns nullptr if there is none.
+const SimStats* attach_stats(const std::string& run_id);
+void detach_stats(const SimStats* stats);
+
+// Monotonic wall-clock milliseconds, the time base for every stats timestamp
+long stats_now_ms();
+
+// Relaxed updates: observers only need eventually-consistent counters, never ordering
+inline void stat_add(std::atomic<long>& counter, long amount = 1) {
+    counter.fetch_add(amount, std::memory_order_relaxed);
+}
+
+inline void stat_add(std::atomic<int>& counter, int amount = 1) {
+    counter.fetch_add(amount, std::memory_order_relaxed);
+}
+
+inline void stat_set(std::atomic<int>& value, int to) {
+    value.store(to, std::memory_order_relaxed);
+}
+
+inline void stat_set(std::atomic<long>& value, long to) {
+    value.store(to, std::memory_order_relaxed);
+}
+
+// Raises value to candidate if it is larger; shards sharing the segment keep the largest
+inline void stat_max(std::atomic<long>& value, long candidate) {
+    long current = value.load(std::memory_order_relaxed);
+    while (candidate > current && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {
+    }
+}
+
+inline void stat_max(std::atomic<int>& value, int candidate) {
+    int current = value.load(std::memory_order_relaxed);
+    while (candidate > current && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {
+    }
+}
+
+#endif // STATS_H
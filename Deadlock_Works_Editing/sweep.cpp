@@ -0,0 +1,443 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Batch runner for capacity planning. Expands a sweep specification into scenarios, runs ./main on
+// each one concurrently (every run gets its own directory and run ID, so their IPC never overlaps) and collects
+// the per-run metrics into one CSV and one JSON table.
+// Usage: ./sweep SPEC [--main=PATH] [--out=DIR] [--jobs=N]
+//
+// Specification (one "key: value" per line, # starts a comment):
+//   intersections: intersections.txt       base network
+//   trains: trains.txt, trains_heavy.txt   train mixes to try
+//   capacity *: 1, 2                       capacity of every intersection
+//   capacity IntersectionA: 1, 2, 3        capacity of one intersection (overrides *)
+//   repeat: 3                              runs per scenario
+//   jobs: 4                                concurrent runs (default: number of cores)
+//   timeout: 120                           seconds before a run is killed
+//   args: --detect=wait:500                extra arguments for every run
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <csignal>
+#include <ctime>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "run_ipc.h"
+
+struct CapacityAxis {
+    std::string intersection; // "*" for every intersection
+    std::vector<int> values;
+};
+
+struct SweepSpec {
+    std::string intersections = "intersections.txt";
+    std::vector<std::string> trains;
+    std::vector<CapacityAxis> capacities;
+    int repeat = 1;
+    int jobs = 0;
+    int timeout_s = 300;
+    std::vector<std::string> args;
+};
+
+struct Scenario {
+    int index;
+    std::string trains;
+    std::map<std::string, int> capacities; // overrides, "*" first
+    int repeat;
+};
+
+struct RunResult {
+    std::string status = "pending";
+    int exit_code = -1;
+    long wall_ms = 0;
+    std::map<std::string, std::string> metrics;
+};
+
+// Metrics written by main --metrics, in table order
+static const char* METRIC_KEYS[] = {"makespan_ms", "grants_per_sec", "deadlocks", "recoveries", "p99_wait_us",
+                                    "requests", "grants", "waits", "sim_time", "trains", "trains_failed"};
+
+static long now_ms() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t\r");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(start, end - start + 1);
+}
+
+static std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, sep)) {
+        part = trim(part);
+        if (!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+static std::string absolute(const std::string& path) {
+    char resolved[PATH_MAX];
+    return realpath(path.c_str(), resolved) ? resolved : path;
+}
+
+static bool parse_spec(const std::string& filename, SweepSpec& spec) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int line_no = 0;
+    while (std::getline(file, line)) {
+        line_no++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        size_t colonPos = line.find(':');
+        if (colonPos == std::string::npos) {
+            std::cerr << "Error: " << filename << ":" << line_no << ": expected key: value\n";
+            return false;
+        }
+        std::string key = trim(line.substr(0, colonPos));
+        std::string value = trim(line.substr(colonPos + 1));
+
+        try {
+            if (key == "intersections") {
+                spec.intersections = value;
+            } else if (key == "trains") {
+                for (const std::string& f : split(value, ',')) spec.trains.push_back(f);
+            } else if (key.rfind("capacity ", 0) == 0) {
+                CapacityAxis axis;
+                axis.intersection = trim(key.substr(9));
+                for (const std::string& v : split(value, ',')) axis.values.push_back(std::stoi(v));
+                if (axis.values.empty()) throw std::invalid_argument(value);
+                spec.capacities.push_back(axis);
+            } else if (key == "repeat") {
+                spec.repeat = std::stoi(value);
+            } else if (key == "jobs") {
+                spec.jobs = std::stoi(value);
+            } else if (key == "timeout") {
+                spec.timeout_s = std::stoi(value);
+            } else if (key == "args") {
+                spec.args = split(value, ' ');
+            } else {
+                std::cerr << "Error: " << filename << ":" << line_no << ": unknown key " << key << "\n";
+                return false;
+            }
+        } catch (...) {
+            std::cerr << "Error: " << filename << ":" << line_no << ": bad value " << value << "\n";
+            return false;
+        }
+    }
+
+    if (spec.trains.empty()) spec.trains.push_back("trains.txt");
+    if (spec.repeat < 1) spec.repeat = 1;
+    return true;
+}
+
+// Cartesian product of train mixes and capacity axes, each repeated
+static std::vector<Scenario> expand(const SweepSpec& spec) {
+    std::vector<Scenario> scenarios;
+    std::vector<size_t> choice(spec.capacities.size(), 0);
+    for (const std::string& trains : spec.trains) {
+        while (true) {
+            for (int r = 0; r < spec.repeat; ++r) {
+                Scenario s;
+                s.index = scenarios.size();
+                s.trains = trains;
+                s.repeat = r;
+                for (size_t a = 0; a < spec.capacities.size(); ++a) {
+                    s.capacities[spec.capacities[a].intersection] = spec.capacities[a].values[choice[a]];
+                }
+                scenarios.push_back(s);
+            }
+
+            // Advance the odometer over the capacity axes
+            size_t a = 0;
+            while (a < choice.size() && ++choice[a] == spec.capacities[a].values.size()) {
+                choice[a++] = 0;
+            }
+            if (a == choice.size()) break;
+        }
+    }
+    return scenarios;
+}
+
+static std::string describe_capacities(const Scenario& s) {
+    std::string out;
+    for (const auto& [name, capacity] : s.capacities) {
+        if (!out.empty()) out += ";";
+        out += name + "=" + std::to_string(capacity);
+    }
+    return out;
+}
+
+// Copies the base network, applying the scenario's capacity overrides
+static bool write_intersections(const std::string& base, const Scenario& s, const std::string& path) {
+    std::ifstream in(base);
+    std::ofstream out(path);
+    if (!in.is_open() || !out.is_open()) return false;
+    auto wildcard = s.capacities.find("*");
+
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t colonPos = line.find(':');
+        if (colonPos == std::string::npos) {
+            out << line << "\n";
+            continue;
+        }
+        std::string name = line.substr(0, colonPos);
+        auto it = s.capacities.find(name);
+        if (it != s.capacities.end()) {
+            out << name << ":" << it->second << "\n";
+        } else if (wildcard != s.capacities.end()) {
+            out << name << ":" << wildcard->second << "\n";
+        } else {
+            out << line << "\n";
+        }
+    }
+    return (bool)out;
+}
+
+static std::string run_dir(const std::string& out_dir, const Scenario& s) {
+    return out_dir + "/run_" + std::to_string(s.index);
+}
+
+static std::string run_id_of(const Scenario& s) {
+    return "sweep" + std::to_string(getpid()) + "-" + std::to_string(s.index);
+}
+
+static pid_t launch(const SweepSpec& spec, const Scenario& s, const std::string& main_path, const std::string& out_dir) {
+    std::string dir = run_dir(out_dir, s);
+    mkdir(dir.c_str(), 0755);
+    if (!write_intersections(spec.intersections, s, dir + "/intersections.txt")) {
+        std::cerr << "Error: Could not write " << dir << "/intersections.txt\n";
+        return -1;
+    }
+
+    std::vector<std::string> args = {main_path, "--trains=" + absolute(s.trains), "--metrics=metrics.txt"};
+    args.insert(args.end(), spec.args.begin(), spec.args.end());
+    std::string run_id = run_id_of(s);
+    // A reused --out directory must not report the previous sweep's metrics for a run that dies
+    unlink((dir + "/metrics.txt").c_str());
+
+    pid_t pid = fork();
+    if (pid != 0) {
+        // Also here, so a kill(-pid) before the child has run still reaches its group
+        if (pid > 0) setpgid(pid, pid);
+        return pid;
+    }
+
+    // Own process group, so a timeout can kill the server and every train with it
+    setpgid(0, 0);
+    if (chdir(dir.c_str()) != 0) _exit(127);
+    int fd = open("output.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+    }
+    setenv("TRAINSIM_RUN_ID", run_id.c_str(), 1);
+
+    std::vector<char*> argv;
+    for (std::string& a : args) argv.push_back(&a[0]);
+    argv.push_back(nullptr);
+    execv(main_path.c_str(), argv.data());
+    perror("execv");
+    _exit(127);
+}
+
+static void read_metrics(const std::string& path, RunResult& result) {
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t eq = line.find('=');
+        if (eq != std::string::npos) result.metrics[line.substr(0, eq)] = line.substr(eq + 1);
+    }
+}
+
+static std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static bool is_number(const std::string& s) {
+    if (s.empty()) return false;
+    char* end;
+    strtod(s.c_str(), &end);
+    return *end == '\0';
+}
+
+static bool write_tables(const std::string& out_dir, const std::vector<Scenario>& scenarios,
+                         const std::vector<RunResult>& results) {
+    std::ofstream csv(out_dir + "/results.csv");
+    std::ofstream json(out_dir + "/results.json");
+    if (!csv.is_open() || !json.is_open()) return false;
+
+    csv << "run,trains_file,capacities,repeat,status,exit_code,wall_ms";
+    for (const char* key : METRIC_KEYS) csv << "," << key;
+    csv << "\n";
+    json << "[\n";
+
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        const Scenario& s = scenarios[i];
+        const RunResult& r = results[i];
+        csv << s.index << "," << s.trains << "," << describe_capacities(s) << "," << s.repeat << ","
+            << r.status << "," << r.exit_code << "," << r.wall_ms;
+        json << "  {\"run\": " << s.index << ", \"trains_file\": \"" << json_escape(s.trains)
+             << "\", \"capacities\": \"" << json_escape(describe_capacities(s)) << "\", \"repeat\": " << s.repeat
+             << ", \"status\": \"" << r.status << "\", \"exit_code\": " << r.exit_code << ", \"wall_ms\": " << r.wall_ms;
+
+        for (const char* key : METRIC_KEYS) {
+            auto it = r.metrics.find(key);
+            std::string value = it == r.metrics.end() ? "" : it->second;
+            csv << "," << value;
+            json << ", \"" << key << "\": " << (is_number(value) ? value : "null");
+        }
+        csv << "\n";
+        json << "}" << (i + 1 < scenarios.size() ? "," : "") << "\n";
+    }
+    json << "]\n";
+    return (bool)csv && (bool)json;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " SPEC [--main=PATH] [--out=DIR] [--jobs=N]\n";
+        return 1;
+    }
+
+    std::string main_path = "./main";
+    std::string out_dir = "sweep_out";
+    int jobs_override = 0;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--main=", 0) == 0) {
+            main_path = arg.substr(7);
+        } else if (arg.rfind("--out=", 0) == 0) {
+            out_dir = arg.substr(6);
+        } else if (arg.rfind("--jobs=", 0) == 0) {
+            jobs_override = atoi(arg.c_str() + 7);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " SPEC [--main=PATH] [--out=DIR] [--jobs=N]\n";
+            return 1;
+        }
+    }
+
+    SweepSpec spec;
+    if (!parse_spec(argv[1], spec)) return 1;
+    if (jobs_override > 0) spec.jobs = jobs_override;
+    if (spec.jobs < 1) spec.jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    if (spec.jobs < 1) spec.jobs = 1;
+
+    main_path = absolute(main_path);
+    if (access(main_path.c_str(), X_OK) != 0) {
+        std::cerr << "Error: " << main_path << " is not executable\n";
+        return 1;
+    }
+    spec.intersections = absolute(spec.intersections);
+    mkdir(out_dir.c_str(), 0755);
+
+    std::vector<Scenario> scenarios = expand(spec);
+    std::vector<RunResult> results(scenarios.size());
+    std::cout << "Sweep: " << scenarios.size() << " runs, " << spec.jobs << " at a time, output in " << out_dir << "\n";
+
+    struct Running {
+        int index;
+        long start_ms;
+        bool term_sent;
+    };
+    std::map<pid_t, Running> running;
+    size_t next = 0;
+    size_t finished = 0;
+    long sweep_start = now_ms();
+
+    while (finished < scenarios.size()) {
+        while (next < scenarios.size() && (int)running.size() < spec.jobs) {
+            const Scenario& s = scenarios[next];
+            pid_t pid = launch(spec, s, main_path, out_dir);
+            if (pid < 0) {
+                results[next].status = "failed_to_start";
+                finished++;
+            } else {
+                results[next].status = "running";
+                running[pid] = {s.index, now_ms(), false};
+            }
+            next++;
+        }
+
+        int status;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid > 0 && running.count(pid)) {
+            Running run = running[pid];
+            running.erase(pid);
+            RunResult& result = results[run.index];
+            result.wall_ms = now_ms() - run.start_ms;
+            if (run.term_sent) {
+                result.status = "timeout";
+            } else if (WIFEXITED(status)) {
+                result.exit_code = WEXITSTATUS(status);
+                result.status = result.exit_code == 0 ? "ok" : "failed";
+            } else {
+                result.status = "killed";
+            }
+            kill(-pid, SIGKILL); // Any train the run left behind
+            // Whatever a killed run could not remove itself; named run IDs are never cleaned up as stale
+            remove_run_segments(run_id_of(scenarios[run.index]));
+            read_metrics(run_dir(out_dir, scenarios[run.index]) + "/metrics.txt", result);
+            finished++;
+
+            std::cout << "[" << finished << "/" << scenarios.size() << "] run_" << run.index << " "
+                      << result.status << " " << result.wall_ms << " ms";
+            if (result.metrics.count("makespan_ms")) {
+                std::cout << "  makespan " << result.metrics["makespan_ms"] << " ms, deadlocks "
+                          << result.metrics["deadlocks"] << ", p99 wait " << result.metrics["p99_wait_us"] << " us";
+            }
+            std::cout << std::endl;
+            continue;
+        }
+
+        // Kill runs that are over time: TERM first so main removes its segments, KILL if it ignores that
+        long now = now_ms();
+        for (auto& [run_pid, run] : running) {
+            long elapsed = now - run.start_ms;
+            if (!run.term_sent && elapsed > spec.timeout_s * 1000L) {
+                kill(-run_pid, SIGTERM);
+                run.term_sent = true;
+            } else if (run.term_sent && elapsed > spec.timeout_s * 1000L + 5000) {
+                kill(-run_pid, SIGKILL);
+            }
+        }
+        usleep(20000);
+    }
+
+    if (!write_tables(out_dir, scenarios, results)) {
+        std::cerr << "Error: Could not write results to " << out_dir << "\n";
+        return 1;
+    }
+    int ok = 0;
+    for (const RunResult& r : results) ok += r.status == "ok";
+    std::cout << "Sweep complete: " << ok << "/" << scenarios.size() << " ok in " << (now_ms() - sweep_start) / 1000.0
+              << " s. Results in " << out_dir << "/results.csv and " << out_dir << "/results.json" << std::endl;
+    return ok == (int)scenarios.size() ? 0 : 1;
+}
@@ -5,30 +5,85 @@
 // Description: Implements acquire and release logic for intersections using synchronization primitives stored in shared memory.
 
 #include "sync.h"
+#include <sched.h>
 
-IntersectionData::IntersectionData() : capacity(0), lock_type(0), num_holding_trains(0) {
-    pthread_mutex_init(&mutex, nullptr);
-    //sem_init(&semaphore, 1, 0); // Initialize to 0, capacity set later
-    memset(holding_trains, 0, sizeof(holding_trains));
+// Retries a reader spins before it assumes the writer was descheduled mid-write and yields
+#define SNAPSHOT_SPINS 64
+
+// Every server shard and train locks these from its own process, which a default (private)
+// mutex does not allow
+static void init_process_shared(pthread_mutex_t* mutex) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+IntersectionData::IntersectionData() : capacity(0), lock_type(0) {
     memset(name, 0, sizeof(name));
 }
 
-IntersectionData::~IntersectionData() {
+IntersectionLock::IntersectionLock() : num_holding_trains(0) {
+    init_process_shared(&mutex);
+    memset(holding_trains, 0, sizeof(holding_trains));
+}
+
+IntersectionLock::~IntersectionLock() {
     pthread_mutex_destroy(&mutex);
-    sem_destroy(&semaphore);
 }
 
-SharedMemory::SharedMemory()  {
-    pthread_mutex_init(&shared_memory_mutex, nullptr);
+SharedMemory::SharedMemory() : table_version(0) {
+    init_process_shared(&shared_memory_mutex);
+    for (int i = 0; i < MAX_INTERSECTIONS; ++i) {
+        ticket_init(&semaphores[i], 0); // capacity set later
+    }
 }
 
 SharedMemory::~SharedMemory() {
     for (int i = 0; i < MAX_INTERSECTIONS; ++i) {
-        intersections[i].~IntersectionData();
+        locks[i].~IntersectionLock();
     }
     pthread_mutex_destroy(&shared_memory_mutex);
 }
 
+// Odd from begin to end. The release fence keeps the table writes from becoming visible before
+// the odd version; the release store keeps them from becoming visible after the even one.
+void table_write_begin(SharedMemory* shm) {
+    shm->table_version.store(shm->table_version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void table_write_end(SharedMemory* shm) {
+    shm->table_version.store(shm->table_version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+int snapshot_intersections(const SharedMemory* shm, TableSnapshot& out) {
+    for (int retries = 0;; ++retries) {
+        if (retries >= SNAPSHOT_SPINS) sched_yield();
+        unsigned before = shm->table_version.load(std::memory_order_acquire);
+        if (before & 1) continue;
+
+        // The copy may race with a writer; it is thrown away unless the version did not move
+        for (int i = 0; i < MAX_INTERSECTIONS; ++i) {
+            const IntersectionData& data = shm->intersections[i];
+            const IntersectionLock& lock = shm->locks[i];
+            IntersectionSnapshot& copy = out.intersections[i];
+            memcpy(copy.name, data.name, sizeof(copy.name));
+            copy.capacity = data.capacity;
+            copy.lock_type = data.lock_type;
+            copy.num_holding_trains = lock.num_holding_trains;
+            memcpy(copy.holding_trains, lock.holding_trains, sizeof(copy.holding_trains));
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (shm->table_version.load(std::memory_order_relaxed) == before) {
+            for (IntersectionSnapshot& copy : out.intersections) copy.name[MAX_INTERSECTION_NAME_LENGTH - 1] = '\0';
+            out.version = before;
+            return retries;
+        }
+    }
+}
+
 // Function to find the index of an intersection by name
 int find_intersection_index(const std::string& name, SharedMemory* shm) {
     for (int i = 0; i < MAX_INTERSECTIONS; ++i) {
@@ -44,9 +99,13 @@ void handle_acquire_request(int train_id, const std::string& intersection_name,
     pthread_mutex_lock(&shm->shared_memory_mutex);
 
     IntersectionData* intersection = nullptr;
+    IntersectionLock* lock = nullptr;
+    TicketSemaphore* semaphore = nullptr;
     for (int i = 0; i < MAX_INTERSECTIONS; ++i) {
         if (strcmp(shm->intersections[i].name, intersection_name.c_str()) == 0) {
             intersection = &shm->intersections[i];
+            lock = &shm->locks[i];
+            semaphore = &shm->semaphores[i];
             break;
         }
     }
@@ -62,25 +121,71 @@ void handle_acquire_request(int train_id, const std::string& intersection_name,
     if (intersection->lock_type == 1) {
         std::cout << "Train " << train_id << " trying to acquire mutex for " << intersection_name << std::endl;
 request[train_id - 1][find_intersection_index(intersection_name, shm)] = 1;
-        pthread_mutex_lock(&intersection->mutex);  // ? blocks if already held
+        pthread_mutex_lock(&lock->mutex);  // ? blocks if already held
         pthread_mutex_lock(&shm->shared_memory_mutex);
-        intersection->holding_trains[0] = train_id;
-        intersection->num_holding_trains = 1;
+        table_write_begin(shm);
+        lock->holding_trains[0] = train_id;
+        lock->num_holding_trains = 1;
+        table_write_end(shm);
         std::cout << "Train " << train_id << " acquired mutex for " << intersection_name << std::endl;
 request[train_id - 1][find_intersection_index(intersection_name, shm)] = 0;
         pthread_mutex_unlock(&shm->shared_memory_mutex);
     } else {
         std::cout << "Train " << train_id << " trying to acquire semaphore for " << intersection_name << std::endl;
 request[train_id - 1][find_intersection_index(intersection_name, shm)] = 1;
-        sem_wait(&intersection->semaphore);  // ? blocks if none available
+        ticket_acquire(semaphore);  // blocks until every earlier arrival is in
         pthread_mutex_lock(&shm->shared_memory_mutex);
-        intersection->holding_trains[intersection->num_holding_trains++] = train_id;
+        table_write_begin(shm);
+        lock->holding_trains[lock->num_holding_trains++] = train_id;
+        table_write_end(shm);
         std::cout << "Train " << train_id << " acquired semaphore for " << intersection_name << std::endl;
 request[train_id - 1][find_intersection_index(intersection_name, shm)] = 0;
         pthread_mutex_unlock(&shm->shared_memory_mutex);
     }
 }
 
+bool try_acquire_intersection(int train_id, int intersection_index, SharedMemory* shm) {
+    pthread_mutex_lock(&shm->shared_memory_mutex);
+
+    IntersectionData* intersection = &shm->intersections[intersection_index];
+    IntersectionLock* lock = &shm->locks[intersection_index];
+    for (int i = 0; i < lock->num_holding_trains; ++i) {
+        if (lock->holding_trains[i] == train_id) {
+            // Not a new grant: reporting one would count the slot twice in the caller's matrices
+            std::cerr << "Error: Train " << train_id << " already holds " << intersection->name << std::endl;
+            pthread_mutex_unlock(&shm->shared_memory_mutex);
+            return false;
+        }
+    }
+
+    bool granted = false;
+    if (intersection->lock_type == 1) {
+        if (lock->num_holding_trains == 0 && intersection->capacity > 0 && pthread_mutex_trylock(&lock->mutex) == 0) {
+            table_write_begin(shm);
+            lock->holding_trains[0] = train_id;
+            lock->num_holding_trains = 1;
+            table_write_end(shm);
+            granted = true;
+            std::cout << "Train " << train_id << " acquired mutex for " << intersection->name << std::endl;
+        } else {
+            std::cout << "Train " << train_id << " waiting for mutex on " << intersection->name << std::endl;
+        }
+    } else {
+        if (lock->num_holding_trains < intersection->capacity && ticket_try_acquire(&shm->semaphores[intersection_index])) {
+            table_write_begin(shm);
+            lock->holding_trains[lock->num_holding_trains++] = train_id;
+            table_write_end(shm);
+            granted = true;
+            std::cout << "Train " << train_id << " acquired semaphore for " << intersection->name << std::endl;
+        } else {
+            std::cout << "Train " << train_id << " waiting for semaphore on " << intersection->name << std::endl;
+        }
+    }
+
+    pthread_mutex_unlock(&shm->shared_memory_mutex);
+    return granted;
+}
+
 // Function to handle RELEASE request from a train
 void handle_release_request(int train_id, const std::string& intersection_name, SharedMemory* shm) {
     pthread_mutex_lock(&shm->shared_memory_mutex); // Lock shared memory for atomic access
@@ -93,27 +198,32 @@ void handle_release_request(int train_id, const std::string& intersection_name,
     }
 
     IntersectionData* intersection = &shm->intersections[intersection_index];
+    IntersectionLock* lock = &shm->locks[intersection_index];
     bool found_train = false;
 
     if (intersection->lock_type == 1) { // Mutex
-        if (intersection->num_holding_trains == 1 && intersection->holding_trains[0] == train_id) {
-            pthread_mutex_unlock(&intersection->mutex);
-            intersection->num_holding_trains = 0;
-            memset(intersection->holding_trains, 0, sizeof(intersection->holding_trains));
+        if (lock->num_holding_trains == 1 && lock->holding_trains[0] == train_id) {
+            pthread_mutex_unlock(&lock->mutex);
+            table_write_begin(shm);
+            lock->num_holding_trains = 0;
+            memset(lock->holding_trains, 0, sizeof(lock->holding_trains));
+            table_write_end(shm);
             found_train = true;
             std::cout << "Train " << train_id << " released mutex for " << intersection_name << std::endl;
         } else {
             std::cerr << "Error: Train " << train_id << " does not hold mutex for " << intersection_name << std::endl;
         }
     } else { // Semaphore
-        for (int i = 0; i < intersection->num_holding_trains; ++i) {
-            if (intersection->holding_trains[i] == train_id) {
+        for (int i = 0; i < lock->num_holding_trains; ++i) {
+            if (lock->holding_trains[i] == train_id) {
                 // Remove train_id from holding_trains
-                for (int j = i; j < intersection->num_holding_trains - 1; ++j) {
-                    intersection->holding_trains[j] = intersection->holding_trains[j + 1];
+                table_write_begin(shm);
+                for (int j = i; j < lock->num_holding_trains - 1; ++j) {
+                    lock->holding_trains[j] = lock->holding_trains[j + 1];
                 }
-                intersection->num_holding_trains--;
-                sem_post(&intersection->semaphore); // Increment semaphore
+                lock->num_holding_trains--;
+                table_write_end(shm);
+                ticket_release(&shm->semaphores[intersection_index]); // Admit the next ticket
                 found_train = true;
                 std::cout << "Train " << train_id << " released semaphore for " << intersection_name << std::endl;
                 break;
@@ -126,3 +236,46 @@ void handle_release_request(int train_id, const std::string& intersection_name,
 
     pthread_mutex_unlock(&shm->shared_memory_mutex); // Unlock shared memory
 }
+
+// Function to apply a reloaded capacity. The server is the only process that locks and unlocks
+// intersections, so it can move the current holders from one kind of lock to the other.
+bool resize_intersection(int intersection_index, int capacity, SharedMemory* shm) {
+    pthread_mutex_lock(&shm->shared_memory_mutex);
+
+    IntersectionData* intersection = &shm->intersections[intersection_index];
+    IntersectionLock* lock = &shm->locks[intersection_index];
+    TicketSemaphore* semaphore = &shm->semaphores[intersection_index];
+    int lock_type = capacity == 1 ? 1 : capacity;
+    bool done = true;
+    table_write_begin(shm);
+    intersection->capacity = capacity;
+
+    if (capacity == 0) { // Retired: nothing new gets in, holders release through the lock they hold
+        if (intersection->lock_type != 1) ticket_set_capacity(semaphore, 0);
+    } else if (intersection->lock_type == 1 && lock_type != 1) {
+        // Mutex to semaphore: the holder, if any, becomes the first admitted ticket
+        ticket_init(semaphore, capacity);
+        if (lock->num_holding_trains > 0) {
+            pthread_mutex_unlock(&lock->mutex);
+            ticket_try_acquire(semaphore);
+        }
+        intersection->lock_type = lock_type;
+    } else if (intersection->lock_type != 1 && lock_type == 1) {
+        // Semaphore to mutex: a capacity-1 semaphore until at most one train is inside
+        ticket_set_capacity(semaphore, 1);
+        if (lock->num_holding_trains <= 1) {
+            if (lock->num_holding_trains == 1) pthread_mutex_trylock(&lock->mutex);
+            intersection->lock_type = 1;
+        } else {
+            done = false;
+        }
+    } else if (lock_type != 1) {
+        ticket_set_capacity(semaphore, capacity);
+        intersection->lock_type = lock_type;
+    }
+    table_write_end(shm);
+    std::cout << "Resized " << intersection->name << " to capacity " << capacity << std::endl;
+
+    pthread_mutex_unlock(&shm->shared_memory_mutex);
+    return done;
+}
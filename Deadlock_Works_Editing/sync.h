@@ -15,11 +15,12 @@
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <pthread.h>
-#include <semaphore.h>
+#include "ticket_sem.h"
 #include <cstring>
 #include <unistd.h>
 #include <map>
 #include <algorithm>
+#include <atomic>
 
 // Define constants
 #define SHM_KEY 12345
@@ -28,29 +29,69 @@
 #define MAX_TRAIN_NAME_LENGTH 50
 #define MAX_INTERSECTION_NAME_LENGTH 50
 
-// Structure to hold intersection data in shared memory
+#define CACHE_LINE_SIZE 64
+
+// Cold per-intersection metadata: written before the fork and on the rare hot reload,
+// only read otherwise, so every process can keep these lines cached
 struct IntersectionData {
     char name[MAX_INTERSECTION_NAME_LENGTH];
-    int capacity;
-    pthread_mutex_t mutex;
-    sem_t semaphore;
+    int capacity;  // 0 once retired by a reload
     int lock_type; // 1 for mutex, >1 for semaphore
-    int holding_trains[MAX_TRAINS_AT_INTERSECTION]; // Array to store holding train IDs
-    int num_holding_trains;
 
     IntersectionData();
-    ~IntersectionData();
 };
 
-// Shared memory structure
+// Hot per-intersection lock state, written on every grant and release. Each one starts on its
+// own cache line so updating one intersection never invalidates its neighbours. A struct per line
+// rather than one array per field: a grant writes the mutex, count and holders together, and
+// separate arrays would spread that over three lines, or pad each entry to a line anyway.
+struct alignas(CACHE_LINE_SIZE) IntersectionLock {
+    pthread_mutex_t mutex;
+    int num_holding_trains;
+    int holding_trains[MAX_TRAINS_AT_INTERSECTION]; // Array to store holding train IDs
+
+    IntersectionLock();
+    ~IntersectionLock();
+};
+
+// Shared memory structure: hot state as cache-line-aligned arrays, then the cold table
 struct SharedMemory {
-    IntersectionData intersections[MAX_INTERSECTIONS];
-    pthread_mutex_t shared_memory_mutex; // Auxiliary mutex
+    IntersectionLock locks[MAX_INTERSECTIONS];
+    TicketSemaphore semaphores[MAX_INTERSECTIONS]; // FIFO admission for capacity > 1
+    alignas(CACHE_LINE_SIZE) pthread_mutex_t shared_memory_mutex; // Auxiliary mutex
+    // Seqlock over intersections[] and the holders in locks[]: odd while a writer (always under
+    // shared_memory_mutex) is changing them, so observers copy and retry instead of locking
+    alignas(CACHE_LINE_SIZE) std::atomic<unsigned> table_version;
+    alignas(CACHE_LINE_SIZE) IntersectionData intersections[MAX_INTERSECTIONS];
 
     SharedMemory();
     ~SharedMemory();
 };
 
+static_assert(std::atomic<unsigned>::is_always_lock_free, "table_version must be lock-free to be shared between processes");
+
+// Consistent copy of one intersection's table entry and holders
+struct IntersectionSnapshot {
+    char name[MAX_INTERSECTION_NAME_LENGTH];
+    int capacity;
+    int lock_type;
+    int num_holding_trains;
+    int holding_trains[MAX_TRAINS_AT_INTERSECTION];
+};
+
+struct TableSnapshot {
+    unsigned version; // table_version the copy was taken at
+    IntersectionSnapshot intersections[MAX_INTERSECTIONS];
+};
+
+// Brackets every change to the intersection table or its holders. Call with shared_memory_mutex held.
+void table_write_begin(SharedMemory* shm);
+void table_write_end(SharedMemory* shm);
+
+// Copies the table without taking any lock, so it works on a read-only mapping and never delays
+// the server. Retries while a write is in progress; returns the number of retries.
+int snapshot_intersections(const SharedMemory* shm, TableSnapshot& out);
+
 // Function to find the index of an intersection by name
 int find_intersection_index(const std::string& name, SharedMemory* shm);
 
@@ -58,7 +99,15 @@ int find_intersection_index(const std::string& name, SharedMemory* shm);
 //void handle_acquire_request(int train_id, const std::string& intersection_name, SharedMemory* shm);
 void handle_acquire_request(int train_id, const std::string& intersection_name, SharedMemory* shm, std::vector<std::vector<int>>& request);
 
+// Function to grant an intersection without blocking the server. Returns true if the train now holds it.
+bool try_acquire_intersection(int train_id, int intersection_index, SharedMemory* shm);
+
 // Function to handle RELEASE request from a train
 void handle_release_request(int train_id, const std::string& intersection_name, SharedMemory* shm);
 
+// Function to change an intersection's capacity while trains hold it (0 retires it: no new grants,
+// holders still release). Returns false if switching a semaphore back to a mutex has to wait until
+// at most one train is inside; the new capacity is enforced either way, call again after releases.
+bool resize_intersection(int intersection_index, int capacity, SharedMemory* shm);
+
 #endif 
@@ -6,11 +6,15 @@
 #include "detect_deadlock.h"
 #include "sync.h"
 #include "log.h"
+#include "components.h"
+#include "thread_pool.h"
+#include "detect_fixed.h"
 #include <iostream>
 #include <vector>
 #include <string>
 #include <numeric>
 #include <cstring>
+#include <random>
 
 using namespace std;
 
@@ -54,6 +58,120 @@ void run_test_case(const string& name,
     }
 }
 
+// Two independent components: trains 0,1 deadlock on I0/I1 while trains 2,3 share I2/I3 safely
+void run_component_case() {
+    vector<vector<int>> allocation = {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 0}};
+    vector<vector<int>> request    = {{0, 1, 0, 0}, {1, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 1, 0}};
+    vector<int> available = {0, 0, 0, 1};
+
+    ResourceComponents components(4, 4);
+    components.link(0, 0); components.link(0, 1);
+    components.link(1, 1); components.link(1, 0);
+    components.link(2, 2); components.link(3, 2); components.link(3, 3);
+
+    cout << "\n==== Test: Component-Scoped Detection ====" << endl;
+    bool full = detect_deadlock(allocation, request, available);
+    bool left = detect_deadlock(allocation, request, available,
+                                components.trains_with(0), components.intersections_with(0));
+    bool right = detect_deadlock(allocation, request, available,
+                                 components.trains_with(3), components.intersections_with(3));
+    bool separate = components.find(0) != components.find(3);
+
+    cout << "Full: " << full << " Left: " << left << " Right: " << right << endl;
+    cout << ((full && left && !right && separate) ? "Scoped detection matches full detection." : "Scoped detection MISMATCH.") << endl;
+}
+
+// Random matrices: the parallel worklist detector must agree with the serial one
+void run_parallel_equivalence_case() {
+    cout << "\n==== Test: Parallel Detection Matches Serial ====" << endl;
+    mt19937 rng(4323);
+    ThreadPool pool(4);
+    int mismatches = 0;
+    int deadlocks = 0;
+    const int cases = 300;
+
+    for (int c = 0; c < cases; ++c) {
+        int n = 1 + rng() % 40;
+        int m = 1 + rng() % 12;
+        vector<int> capacity(m);
+        for (int j = 0; j < m; ++j) capacity[j] = 1 + rng() % 3;
+
+        vector<vector<int>> allocation(n, vector<int>(m, 0));
+        vector<vector<int>> request(n, vector<int>(m, 0));
+        vector<int> available = capacity;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < m; ++j) {
+                if (available[j] > 0 && rng() % 4 == 0) {
+                    allocation[i][j] = 1;
+                    available[j]--;
+                }
+                if (allocation[i][j] == 0 && rng() % 6 == 0) request[i][j] = 1 + rng() % 2;
+            }
+        }
+
+        bool serial = detect_deadlock(allocation, request, available);
+        bool parallel = detect_deadlock_parallel(allocation, request, available, pool);
+        if (serial) deadlocks++;
+        if (serial != parallel) mismatches++;
+    }
+
+    cout << cases << " cases, " << deadlocks << " deadlocked, " << mismatches << " mismatches" << endl;
+    cout << (mismatches == 0 ? "Parallel detection matches serial." : "Parallel detection MISMATCH.") << endl;
+}
+
+// Compile-time checks of the specialized detector: the 3-cycle, and the 8-intersection chain
+// where each train holds one intersection and wants the next
+constexpr FixedResourceTable<3, 3> fixed_cycle{{0b001, 0b010, 0b100}, {0b010, 0b100, 0b001}, {0, 0, 0}};
+static_assert(detect_deadlock(fixed_cycle), "3-cycle must deadlock");
+
+constexpr FixedResourceTable<8, 8> make_chain(bool close_cycle) {
+    FixedResourceTable<8, 8> table{};
+    for (int i = 0; i < 8; ++i) {
+        table.allocation[i] = uint64_t(1) << i;
+        if (i + 1 < 8) table.request[i] = uint64_t(1) << (i + 1);
+        else if (close_cycle) table.request[i] = 1;
+    }
+    return table;
+}
+static_assert(!detect_deadlock(make_chain(false)), "open chain unwinds from its last train");
+static_assert(detect_deadlock(make_chain(true)), "closed chain must deadlock");
+
+// The dispatcher, on random scopes that fit the fixed sizes, against the vector version
+void run_fixed_equivalence_case() {
+    cout << "\n==== Test: Fixed-Size Detection Matches Generic ====" << endl;
+    mt19937 rng(7);
+    int cases = 500, mismatches = 0, deadlocks = 0;
+    for (int c = 0; c < cases; ++c) {
+        int n = 1 + rng() % 16, m = 1 + rng() % 16;
+        vector<vector<int>> allocation(n, vector<int>(m, 0));
+        vector<vector<int>> request(n, vector<int>(m, 0));
+        vector<int> available(m);
+        for (int j = 0; j < m; ++j) available[j] = 1 + rng() % 2;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < m; ++j) {
+                if (available[j] > 0 && rng() % 3 == 0) {
+                    allocation[i][j] = 1;
+                    available[j]--;
+                }
+                if (allocation[i][j] == 0 && rng() % 5 == 0) request[i][j] = 1;
+            }
+        }
+        if (rng() % 4 == 0) available[rng() % m] = -1; // a reload shrank a capacity below its holders
+
+        vector<int> trains(n), resources(m);
+        iota(trains.begin(), trains.end(), 0);
+        iota(resources.begin(), resources.end(), 0);
+        cout.setstate(ios::failbit);
+        bool generic = detect_deadlock(allocation, request, available, trains, resources);
+        bool fixed = detect_deadlock_dispatch(allocation, request, available, trains, resources);
+        cout.clear();
+        if (generic) deadlocks++;
+        if (generic != fixed) mismatches++;
+    }
+    cout << cases << " cases, " << deadlocks << " deadlocked, " << mismatches << " mismatches" << endl;
+    cout << (mismatches == 0 ? "Fixed-size detection matches generic." : "Fixed-size detection MISMATCH.") << endl;
+}
+
 int main() {
     // Deadlock Case (Circular Wait)
     run_test_case("Circular Wait Deadlock", {
@@ -86,5 +204,9 @@ int main() {
         {0, 1}, {1, 0}, {1, 1}
     }, {0, 0});
 
+    run_component_case();
+    run_parallel_equivalence_case();
+    run_fixed_equivalence_case();
+
     return 0;
 }
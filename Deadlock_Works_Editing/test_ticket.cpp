@@ -0,0 +1,154 @@
+// Group : I
+// Author: Samuel Shankle
+// Email: samuel.shankle@okstate.edu
+// Date: 10/19/2026
+// Description: Stress test for the FIFO ticket semaphore against sem_t. Hundreds of train processes hammer one
+// capacity-N intersection; reports max/p99 wait and how far admissions strayed from arrival order, and checks that
+// capacity is never exceeded. Usage: ./test_ticket [trains] [capacity] [rounds]
+#include "ticket_sem.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <ctime>
+#include <semaphore.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+struct Sample {
+    long wait_ns;
+    long bypass; // admissions minus arrivals before ours: > capacity means someone jumped the queue
+};
+
+struct Arena {
+    TicketSemaphore ticket;
+    sem_t sem;
+    atomic<long> arrivals;
+    atomic<long> admissions;
+    atomic<int> inside;
+    atomic<int> max_inside;
+    Sample samples[1]; // trains * rounds, allocated with the arena
+};
+
+static long now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void spin_ns(long ns) {
+    long end = now_ns() + ns;
+    while (now_ns() < end) {
+    }
+}
+
+static void train(Arena* arena, bool use_ticket, int id, int rounds) {
+    for (int r = 0; r < rounds; ++r) {
+        long arrived = arena->arrivals.fetch_add(1);
+        long start = now_ns();
+        if (use_ticket) ticket_acquire(&arena->ticket);
+        else sem_wait(&arena->sem);
+        long admitted = arena->admissions.fetch_add(1);
+        arena->samples[id * rounds + r] = {now_ns() - start, admitted - arrived};
+
+        int inside = arena->inside.fetch_add(1) + 1;
+        int seen = arena->max_inside.load();
+        while (inside > seen && !arena->max_inside.compare_exchange_weak(seen, inside)) {
+        }
+        spin_ns(20000); // traverse
+        arena->inside.fetch_sub(1);
+
+        if (use_ticket) ticket_release(&arena->ticket);
+        else sem_post(&arena->sem);
+        usleep(100); // travel to the next visit
+    }
+    _exit(0);
+}
+
+static bool run_case(const string& name, bool use_ticket, int trains, int capacity, int rounds) {
+    size_t size = sizeof(Arena) + sizeof(Sample) * trains * rounds;
+    Arena* arena = (Arena*)mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    ticket_init(&arena->ticket, capacity);
+    sem_init(&arena->sem, 1, capacity);
+
+    long start = now_ns();
+    vector<pid_t> pids;
+    for (int t = 0; t < trains; ++t) {
+        pid_t pid = fork();
+        if (pid == 0) train(arena, use_ticket, t, rounds);
+        pids.push_back(pid);
+    }
+    for (pid_t pid : pids) waitpid(pid, nullptr, 0);
+    double elapsed_s = (now_ns() - start) / 1e9;
+
+    vector<long> waits;
+    long max_bypass = 0;
+    long queue_jumps = 0;
+    for (int i = 0; i < trains * rounds; ++i) {
+        waits.push_back(arena->samples[i].wait_ns);
+        max_bypass = max(max_bypass, arena->samples[i].bypass);
+        if (arena->samples[i].bypass > capacity) queue_jumps++;
+    }
+    sort(waits.begin(), waits.end());
+    bool capacity_ok = arena->max_inside.load() <= capacity;
+
+    cout << left << setw(8) << name << fixed << setprecision(2)
+         << " p50 " << setw(9) << waits[waits.size() / 2] / 1e3
+         << " p99 " << setw(9) << waits[waits.size() * 99 / 100] / 1e3
+         << " max " << setw(10) << waits.back() / 1e3 << " us"
+         << "  max bypass " << setw(5) << max_bypass
+         << " late admissions " << setw(6) << queue_jumps
+         << " max inside " << arena->max_inside.load() << "/" << capacity
+         << "  " << elapsed_s << " s" << (capacity_ok ? "" : "  CAPACITY EXCEEDED") << endl;
+
+    sem_destroy(&arena->sem);
+    munmap(arena, size);
+    return capacity_ok;
+}
+
+// Uncontended acquire + release, the cost every grant pays
+static void run_overhead(int capacity) {
+    const int iterations = 2000000;
+    TicketSemaphore ticket;
+    ticket_init(&ticket, capacity);
+    sem_t sem;
+    sem_init(&sem, 0, capacity);
+
+    long start = now_ns();
+    for (int i = 0; i < iterations; ++i) {
+        ticket_acquire(&ticket);
+        ticket_release(&ticket);
+    }
+    long ticket_ns = now_ns() - start;
+
+    start = now_ns();
+    for (int i = 0; i < iterations; ++i) {
+        sem_wait(&sem);
+        sem_post(&sem);
+    }
+    long sem_ns = now_ns() - start;
+    sem_destroy(&sem);
+
+    cout << "Uncontended acquire+release: ticket " << (double)ticket_ns / iterations << " ns, sem_t "
+         << (double)sem_ns / iterations << " ns" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int trains = argc > 1 ? stoi(argv[1]) : 200;
+    int capacity = argc > 2 ? stoi(argv[2]) : 3;
+    int rounds = argc > 3 ? stoi(argv[3]) : 20;
+
+    cout << "=== Ticket semaphore stress: " << trains << " trains, capacity " << capacity << ", "
+         << rounds << " visits each ===" << endl;
+    cout << "(bypass = admissions minus arrivals ahead of us; FIFO keeps it within capacity plus scheduling noise)" << endl;
+    bool ok = run_case("ticket", true, trains, capacity, rounds);
+    ok = run_case("sem_t", false, trains, capacity, rounds) && ok;
+    run_overhead(capacity);
+
+    cout << (ok ? "PASS" : "FAIL") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+// Group : I
+// Author: Brandon Collings
+// Email: brandon.l.collings@okstate.edu
+// Date: 10/19/2026
+// Description: Implements the fixed-size thread pool.
+
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int num_threads)
+    : num_threads(num_threads < 1 ? 1 : num_threads), job(nullptr), job_count(0),
+      generation(0), pending(0), stopping(false)
+{
+    for (int w = 1; w < this->num_threads; ++w) {
+        workers.emplace_back(&ThreadPool::worker_loop, this, w);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start_cv.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
+
+void ThreadPool::run_chunk(int worker) {
+    int chunk = (job_count + num_threads - 1) / num_threads;
+    int begin = worker * chunk;
+    int end = begin + chunk < job_count ? begin + chunk : job_count;
+    if (begin < end) {
+        (*job)(worker, begin, end);
+    }
+}
+
+void ThreadPool::worker_loop(int worker) {
+    long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_cv.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+
+        run_chunk(worker);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) {
+            done_cv.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallel_for(int count, const std::function<void(int, int, int)>& fn) {
+    if (num_threads == 1 || count <= 1) {
+        if (count > 0) fn(0, 0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        job_count = count;
+        pending = num_threads - 1;
+        generation++;
+    }
+    start_cv.notify_all();
+
+    run_chunk(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cv.wait(lock, [&] { return pending == 0; });
+    job = nullptr;
+}
@@ -0,0 +1,46 @@
+// Group : I
+// Author: Brandon Collings
+// Email: brandon.l.collings@okstate.edu
+// Date: 10/19/2026
+// Description: Declares a small fixed-size thread pool used to split deadlock detection work across cores.
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Persistent workers that run one parallel_for at a time. The calling thread takes
+// part as worker 0, so a pool of size 1 runs everything inline. Create pools after
+// fork(), never before: threads do not survive into the child.
+class ThreadPool {
+public:
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    int size() const { return num_threads; }
+
+    // Splits [0, count) into size() contiguous chunks and calls fn(worker, begin, end)
+    // for each one. Returns once every chunk has finished.
+    void parallel_for(int count, const std::function<void(int, int, int)>& fn);
+
+private:
+    int num_threads;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    const std::function<void(int, int, int)>* job;
+    int job_count;
+    long generation;
+    int pending;
+    bool stopping;
+
+    void worker_loop(int worker);
+    void run_chunk(int worker);
+};
+
+#endif // THREAD_POOL_H
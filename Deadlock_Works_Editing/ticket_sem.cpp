@@ -0,0 +1,78 @@
+// Group : I
+// Author: Samuel Shankle
+// Email: samuel.shankle@okstate.edu
+// Date: 10/19/2026
+// Description: Implements the FIFO ticket semaphore on Linux futexes.
+
+#include "ticket_sem.h"
+#include <climits>
+#include <cstring>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+// Shared (not FUTEX_PRIVATE) because the words live in memory mapped by several processes
+static void futex_wait(std::atomic<uint32_t>* word, uint32_t expected) {
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, expected, nullptr, nullptr, 0);
+}
+
+static void futex_wake_all(std::atomic<uint32_t>* word) {
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void ticket_init(TicketSemaphore* sem, int capacity) {
+    memset((void*)sem, 0, sizeof(TicketSemaphore)); // zero bytes are valid lock-free atomics
+    sem->capacity = capacity;
+}
+
+// Holders release out of ticket order, so released can pass an admitted ticket that has not run
+// yet. The signed distance then goes negative and the ticket stays admitted; unsigned it would wrap.
+static bool admitted(const TicketSemaphore* sem, uint32_t ticket) {
+    return (int32_t)(ticket - sem->released.load()) < sem->capacity.load();
+}
+
+void ticket_acquire(TicketSemaphore* sem) {
+    uint32_t ticket = sem->next_ticket.fetch_add(1);
+    if (admitted(sem, ticket)) {
+        return;
+    }
+
+    std::atomic<uint32_t>* slot = &sem->slot_seq[ticket % TICKET_SLOTS];
+    sem->waiting.fetch_add(1);
+    while (true) {
+        // Read the slot before re-checking: a release in between bumps it and the wait returns at once
+        uint32_t seq = slot->load();
+        if (admitted(sem, ticket)) break;
+        futex_wait(slot, seq);
+    }
+    sem->waiting.fetch_sub(1);
+}
+
+bool ticket_try_acquire(TicketSemaphore* sem) {
+    uint32_t ticket = sem->next_ticket.load();
+    while (admitted(sem, ticket)) {
+        if (sem->next_ticket.compare_exchange_weak(ticket, ticket + 1)) return true;
+    }
+    return false;
+}
+
+void ticket_release(TicketSemaphore* sem) {
+    uint32_t released = sem->released.fetch_add(1) + 1;
+    if (sem->waiting.load() == 0) return;
+
+    // The one ticket that just became admissible
+    std::atomic<uint32_t>* slot = &sem->slot_seq[(released + sem->capacity - 1) % TICKET_SLOTS];
+    slot->fetch_add(1);
+    futex_wake_all(slot);
+}
+
+void ticket_set_capacity(TicketSemaphore* sem, int capacity) {
+    int old_capacity = sem->capacity.exchange(capacity);
+    if (capacity <= old_capacity || sem->waiting.load() == 0) return;
+
+    // Several tickets may have become admissible at once, and they can sit in any slot
+    for (int i = 0; i < TICKET_SLOTS; ++i) {
+        sem->slot_seq[i].fetch_add(1);
+        futex_wake_all(&sem->slot_seq[i]);
+    }
+}
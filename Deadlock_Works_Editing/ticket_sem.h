@@ -0,0 +1,42 @@
+// Group : I
+// Author: Samuel Shankle
+// Email: samuel.shankle@okstate.edu
+// Date: 10/19/2026
+// Description: Declares a process-shared, capacity-N ticket semaphore. Unlike sem_t it admits waiters strictly in
+// arrival order: each acquire takes a ticket and enters once fewer than capacity earlier tickets are still inside.
+
+#ifndef TICKET_SEM_H
+#define TICKET_SEM_H
+
+#include <atomic>
+#include <cstdint>
+
+// Waiters sleep on one of these futex words (ticket % TICKET_SLOTS), so a release wakes only
+// the waiter whose turn it is, plus any sharing its slot once more than TICKET_SLOTS are waiting
+#define TICKET_SLOTS 64
+
+struct alignas(64) TicketSemaphore { // a cache line of counters, then the slots
+    std::atomic<uint32_t> next_ticket; // tickets handed out
+    std::atomic<uint32_t> released;    // tickets that have left; ticket t is in once (int32_t)(t - released) < capacity
+    std::atomic<int> waiting;          // acquirers asleep or about to sleep, lets release skip the wake syscall
+    std::atomic<int> capacity;         // changes only on a hot reload
+    std::atomic<uint32_t> slot_seq[TICKET_SLOTS];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "ticket counters must be lock-free to be shared between processes");
+
+void ticket_init(TicketSemaphore* sem, int capacity);
+
+// Blocks until this caller's ticket is admitted
+void ticket_acquire(TicketSemaphore* sem);
+
+// Admits the caller only if nobody is queued and there is room. Never jumps the queue.
+bool ticket_try_acquire(TicketSemaphore* sem);
+
+void ticket_release(TicketSemaphore* sem);
+
+// Changes the capacity in place. Growing wakes every waiter that now fits; shrinking admits no
+// one new until enough holders have released.
+void ticket_set_capacity(TicketSemaphore* sem, int capacity);
+
+#endif // TICKET_SEM_H
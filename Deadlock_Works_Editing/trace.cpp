@@ -0,0 +1,115 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Implements the Chrome Trace Event sink. Each process keeps its events in memory and appends them
+// with one write() per 64 KiB; the file is opened with O_APPEND, so the writes of forked processes never
+// interleave. The JSON array format lets the closing bracket go missing, so a killed run still loads.
+
+#include "trace.h"
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+
+#define TRACE_FLUSH_BYTES (64 * 1024)
+
+static int trace_fd = -1;
+static pid_t buffer_pid = -1;   // process the buffered events belong to
+static std::string buffer;
+
+static void write_all(const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = write(trace_fd, data.data() + written, data.size() - written);
+        if (n <= 0) return;
+        written += n;
+    }
+}
+
+static std::string quoted(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        if ((unsigned char)c >= 0x20) out += c;
+    }
+    return out + "\"";
+}
+
+// A forked child starts with a copy of its parent's unwritten events; they are the parent's to write
+static void append(const std::string& event) {
+    if (trace_fd < 0) return;
+    if (buffer_pid != getpid()) {
+        buffer.clear();
+        buffer_pid = getpid();
+    }
+    buffer += event;
+    buffer += ",\n";
+    if (buffer.size() >= TRACE_FLUSH_BYTES) trace_flush();
+}
+
+bool trace_open(const std::string& path) {
+    trace_fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (trace_fd < 0) {
+        perror(("open " + path).c_str());
+        return false;
+    }
+    write_all("[\n");
+    static bool registered = false;
+    if (!registered) atexit(trace_flush);
+    registered = true;
+    trace_process_name(TRACE_TRAINS_PID, "Trains");
+    return true;
+}
+
+void trace_close() {
+    if (trace_fd < 0) return;
+    trace_flush();
+    // Last element without a trailing comma, so the array closes cleanly
+    write_all("{\"ph\":\"M\",\"pid\":" + std::to_string(TRACE_TRAINS_PID) +
+              ",\"name\":\"process_sort_index\",\"args\":{\"sort_index\":0}}\n]\n");
+    close(trace_fd);
+    trace_fd = -1;
+}
+
+bool trace_enabled() {
+    return trace_fd >= 0;
+}
+
+void trace_flush() {
+    if (trace_fd < 0 || buffer_pid != getpid() || buffer.empty()) return;
+    write_all(buffer);
+    buffer.clear();
+}
+
+void trace_slice(int pid, int tid, const std::string& name, const char* cat, long start_us, long dur_us,
+                 const std::string& args) {
+    if (trace_fd < 0) return;
+    append("{\"ph\":\"X\",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid) + ",\"name\":" +
+           quoted(name) + ",\"cat\":\"" + cat + "\",\"ts\":" + std::to_string(start_us) + ",\"dur\":" +
+           std::to_string(dur_us) + (args.empty() ? "" : ",\"args\":{" + args + "}") + "}");
+}
+
+void trace_instant(int pid, int tid, const std::string& name, const char* cat, long ts_us) {
+    if (trace_fd < 0) return;
+    append("{\"ph\":\"i\",\"s\":\"t\",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid) + ",\"name\":" +
+           quoted(name) + ",\"cat\":\"" + cat + "\",\"ts\":" + std::to_string(ts_us) + "}");
+}
+
+void trace_train_span(char phase, int train_id, const std::string& name, const char* cat, long id, long ts_us) {
+    if (trace_fd < 0) return;
+    append(std::string("{\"ph\":\"") + phase + "\",\"pid\":" + std::to_string(TRACE_TRAINS_PID) + ",\"tid\":" +
+           std::to_string(train_id) + ",\"name\":" + quoted(name) + ",\"cat\":\"" + cat + "\",\"id\":" +
+           std::to_string(id) + ",\"ts\":" + std::to_string(ts_us) + "}");
+}
+
+void trace_process_name(int pid, const std::string& name) {
+    if (trace_fd < 0) return;
+    append("{\"ph\":\"M\",\"pid\":" + std::to_string(pid) + ",\"name\":\"process_name\",\"args\":{\"name\":" +
+           quoted(name) + "}}");
+}
+
+void trace_thread_name(int pid, int tid, const std::string& name) {
+    if (trace_fd < 0) return;
+    append("{\"ph\":\"M\",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid) +
+           ",\"name\":\"thread_name\",\"args\":{\"name\":" + quoted(name) + "}}");
+}
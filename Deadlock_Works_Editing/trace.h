@@ -0,0 +1,39 @@
+// Group : I
+// Author: Angel Trujillo
+// Date: 10/19/2026
+// Description: Declares the optional Chrome Trace Event sink (--trace=PATH). The file loads in chrome://tracing
+// and ui.perfetto.dev: every train is a thread of the "Trains" process with an async span per wait and per
+// intersection hold, and every server shard is a process with slices for its request batches and deadlock checks.
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+
+// Process the train tracks are grouped under (trains are not processes of their own in the trace)
+#define TRACE_TRAINS_PID 1
+
+// Starts the trace: truncates path and writes the opening bracket. Call once per run before
+// fork(); every process forked afterwards buffers its own events and appends them in bulk.
+bool trace_open(const std::string& path);
+
+// Ends the JSON array. Call after every other process that traces has exited.
+void trace_close();
+
+bool trace_enabled();
+
+// Writes this process's buffered events. Also runs at exit in every process.
+void trace_flush();
+
+// args is the inside of the "args" object, e.g. "\"requests\":3", or empty
+void trace_slice(int pid, int tid, const std::string& name, const char* cat, long start_us, long dur_us,
+                 const std::string& args = "");
+void trace_instant(int pid, int tid, const std::string& name, const char* cat, long ts_us);
+
+// Async span on a train's track: phase 'b' opens it and 'e' closes the one with the same cat and id
+void trace_train_span(char phase, int train_id, const std::string& name, const char* cat, long id, long ts_us);
+
+void trace_process_name(int pid, const std::string& name);
+void trace_thread_name(int pid, int tid, const std::string& name);
+
+#endif // TRACE_H
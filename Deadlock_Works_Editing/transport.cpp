@@ -0,0 +1,542 @@
+// Group : I
+// Author: Wyatt Probst
+// Date: 10/19/2026
+// Description: Implements the SysV message queue, TCP and Unix socket transports. Socket frames are raw
+// TrainMessage structs, so every node must share the same build and architecture.
+
+#include "transport.h"
+#include <iostream>
+#include <map>
+#include <unordered_map>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ipc.h>
+#include <sys/msg.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+
+#define FRAME_SIZE sizeof(TrainMessage)
+
+bool parse_transport(const std::string& spec, TransportConfig& config) {
+    if (spec == "msgq") {
+        config.kind = TRANSPORT_MSGQUEUE;
+        return true;
+    }
+    if (spec.rfind("unix:", 0) == 0 && spec.size() > 5) {
+        config.kind = TRANSPORT_UNIX;
+        config.path = spec.substr(5);
+        return true;
+    }
+    if (spec.rfind("tcp:", 0) == 0) {
+        size_t colonPos = spec.rfind(':');
+        if (colonPos <= 4) return false;
+        config.kind = TRANSPORT_TCP;
+        config.host = spec.substr(4, colonPos - 4);
+        try {
+            config.port = std::stoi(spec.substr(colonPos + 1));
+        } catch (...) {
+            return false;
+        }
+        return config.port > 0 && config.port < 65536;
+    }
+    return false;
+}
+
+std::string describe_transport(const TransportConfig& config) {
+    std::string shards = config.num_shards > 1 ? " x" + std::to_string(config.num_shards) + " shards" : "";
+    switch (config.kind) {
+        case TRANSPORT_MSGQUEUE: return "SysV message queue";
+        case TRANSPORT_TCP:      return "tcp " + config.host + ":" + std::to_string(config.port) + shards;
+        case TRANSPORT_UNIX:     return "unix " + config.path + shards;
+    }
+    return "unknown";
+}
+
+int shard_of(const std::string& intersection, int num_shards) {
+    if (num_shards <= 1) return 0;
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : intersection) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash % num_shards;
+}
+
+long backoff_ms(int attempt, long floor_ms) {
+    // Seeded per process, so trains forked from one parent do not retry in lockstep
+    static unsigned seed = 0;
+    static pid_t seeded_for = -1;
+    if (seeded_for != getpid()) {
+        seeded_for = getpid();
+        seed = (unsigned)getpid() ^ (unsigned)time(nullptr);
+    }
+    long range = BACKOFF_BASE_MS;
+    for (int i = 0; i < attempt && range < BACKOFF_MAX_MS; ++i) range *= 2;
+    if (range > BACKOFF_MAX_MS) range = BACKOFF_MAX_MS;
+    return floor_ms + rand_r(&seed) % (range + 1);
+}
+
+// ---------------------------------------------------------------- SysV message queue
+
+class MsgQueueServer : public ServerTransport {
+public:
+    explicit MsgQueueServer(int msgid) : msgid(msgid) {}
+
+    int receive(TrainMessage& msg, bool wait) override {
+        if (msgrcv(msgid, &msg, MSG_SIZE, REQUEST_TYPE, IPC_NOWAIT) >= 0) return 1;
+        if (errno == ENOMSG) {
+            // Queue drained: the replies go out before waiting for more
+            flush();
+            if (!wait) return 0;
+            if (!replies.empty()) {
+                // The queue is full of replies trains have not picked up yet. Blocking here would
+                // leave the rest unsent, so poll until there is room for them.
+                usleep(backoff_ms(0, 1) * 1000);
+                return 0;
+            }
+            if (msgrcv(msgid, &msg, MSG_SIZE, REQUEST_TYPE, 0) >= 0) return 1;
+        }
+        if (errno == EINTR || errno == ENOMSG) return 0;
+        perror("msgrcv");
+        return -1;
+    }
+
+    void send(const TrainMessage& msg) override {
+        replies.push_back(msg);
+    }
+
+    // A full queue keeps the rest for the next flush: blocking would stop the server draining
+    // the requests that fill it, while the trains that could make room may be waiting to send
+    void flush() override {
+        size_t sent = 0;
+        while (sent < replies.size()) {
+            if (msgsnd(msgid, &replies[sent], MSG_SIZE, IPC_NOWAIT) == 0) {
+                sent++;
+                continue;
+            }
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) break;
+            perror("msgsnd");
+            sent++; // Undeliverable, dropped
+        }
+        replies.erase(replies.begin(), replies.begin() + sent);
+    }
+
+    long queue_depth() override {
+        msqid_ds info;
+        if (msgctl(msgid, IPC_STAT, &info) != 0) return -1;
+        return info.msg_qnum;
+    }
+
+private:
+    int msgid;
+    std::vector<TrainMessage> replies;
+};
+
+class MsgQueueTrain : public TrainTransport {
+public:
+    explicit MsgQueueTrain(int msgid) : msgid(msgid) {}
+
+    // IPC_NOWAIT so a full queue is counted and backed off from instead of blocking unseen
+    void send(const TrainMessage& msg) override {
+        for (int attempt = 0; msgsnd(msgid, &msg, MSG_SIZE, IPC_NOWAIT) != 0; ++attempt) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN) {
+                perror("msgsnd");
+                return;
+            }
+            retries++;
+            usleep(backoff_ms(attempt, 0) * 1000);
+        }
+    }
+
+    bool receive(int train_id, TrainMessage& msg) override {
+        while (msgrcv(msgid, &msg, MSG_SIZE, REPLY_TYPE(train_id), 0) < 0) {
+            if (errno != EINTR) return false;
+        }
+        return true;
+    }
+
+    void flush() override {}
+
+    void send_control(const char* command) override {
+        TrainMessage control_msg;
+        memset(&control_msg, 0, sizeof(control_msg));
+        control_msg.type = REQUEST_TYPE;
+        strncpy(control_msg.command, command, sizeof(control_msg.command) - 1);
+        msgsnd(msgid, &control_msg, MSG_SIZE, 0);
+    }
+
+    long full_retries() override {
+        return retries;
+    }
+
+private:
+    int msgid;
+    long retries = 0;
+};
+
+// ---------------------------------------------------------------- sockets
+
+struct Connection {
+    int fd = -1;
+    std::string in;  // bytes read but not yet parsed into frames
+    std::string out; // frames queued but not yet written
+};
+
+static std::string unix_path(const TransportConfig& config, int shard) {
+    return config.path + "." + std::to_string(shard);
+}
+
+static bool resolve_tcp(const TransportConfig& config, int shard, sockaddr_in& addr) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config.port + shard);
+    if (inet_pton(AF_INET, config.host.c_str(), &addr.sin_addr) == 1) return true;
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(config.host.c_str(), nullptr, &hints, &result) != 0 || !result) return false;
+    addr.sin_addr = ((sockaddr_in*)result->ai_addr)->sin_addr;
+    freeaddrinfo(result);
+    return true;
+}
+
+static void set_nonblocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+static int listen_on(const TransportConfig& config, int shard) {
+    int fd;
+    if (config.kind == TRANSPORT_TCP) {
+        sockaddr_in addr;
+        if (!resolve_tcp(config, shard, addr)) {
+            std::cerr << "Error: Could not resolve " << config.host << std::endl;
+            return -1;
+        }
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            perror("bind");
+            close(fd);
+            return -1;
+        }
+    } else {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        std::string path = unix_path(config, shard);
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(path.c_str());
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            perror("bind");
+            close(fd);
+            return -1;
+        }
+    }
+
+    if (listen(fd, 512) < 0) {
+        perror("listen");
+        close(fd);
+        return -1;
+    }
+    set_nonblocking(fd);
+    return fd;
+}
+
+// Servers may still be starting when trains connect, so keep retrying for a few seconds
+static int connect_to(const TransportConfig& config, int shard) {
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        int fd;
+        int rc;
+        if (config.kind == TRANSPORT_TCP) {
+            sockaddr_in addr;
+            if (!resolve_tcp(config, shard, addr)) return -1;
+            fd = socket(AF_INET, SOCK_STREAM, 0);
+            rc = connect(fd, (sockaddr*)&addr, sizeof(addr));
+            if (rc == 0) {
+                int on = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)); // we batch frames ourselves
+            }
+        } else {
+            sockaddr_un addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sun_family = AF_UNIX;
+            std::string path = unix_path(config, shard);
+            strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+            fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            rc = connect(fd, (sockaddr*)&addr, sizeof(addr));
+        }
+        if (rc == 0) return fd;
+        close(fd);
+        usleep(50000);
+    }
+    std::cerr << "Error: Could not connect to shard " << shard << " (" << describe_transport(config) << ")" << std::endl;
+    return -1;
+}
+
+// Moves every complete frame out of conn.in. Returns how many were parsed.
+static int parse_frames(Connection& conn, std::deque<TrainMessage>& frames) {
+    size_t offset = 0;
+    int parsed = 0;
+    while (conn.in.size() - offset >= FRAME_SIZE) {
+        TrainMessage msg;
+        memcpy(&msg, conn.in.data() + offset, FRAME_SIZE);
+        frames.push_back(msg);
+        offset += FRAME_SIZE;
+        parsed++;
+    }
+    conn.in.erase(0, offset);
+    return parsed;
+}
+
+// Reads whatever is available. Returns false once the peer has closed the connection.
+static bool read_available(Connection& conn) {
+    char buf[16384];
+    while (true) {
+        ssize_t n = recv(conn.fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n > 0) {
+            conn.in.append(buf, n);
+            continue;
+        }
+        if (n == 0) return false;
+        if (errno == EINTR) continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+}
+
+// Writes as much of conn.out as the socket takes. Returns false on a broken connection.
+static bool write_pending(Connection& conn, bool block) {
+    size_t offset = 0;
+    while (offset < conn.out.size()) {
+        ssize_t n = ::send(conn.fd, conn.out.data() + offset, conn.out.size() - offset,
+                           MSG_NOSIGNAL | (block ? 0 : MSG_DONTWAIT));
+        if (n > 0) {
+            offset += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && !block && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        conn.out.erase(0, offset);
+        return false;
+    }
+    conn.out.erase(0, offset);
+    return true;
+}
+
+class SocketServer : public ServerTransport {
+public:
+    SocketServer(const TransportConfig& config, int shard) { listen_fd = listen_on(config, shard); }
+
+    ~SocketServer() override {
+        for (auto& entry : conns) close(entry.first);
+        if (listen_fd >= 0) close(listen_fd);
+    }
+
+    int receive(TrainMessage& msg, bool wait) override {
+        if (listen_fd < 0) return -1;
+
+        while (ready.empty()) {
+            // Nothing left to hand out: write every buffered reply in one go before sleeping
+            flush();
+
+            std::vector<pollfd> fds;
+            fds.push_back({listen_fd, POLLIN, 0});
+            for (auto& entry : conns) {
+                short events = POLLIN;
+                if (!entry.second.out.empty()) events |= POLLOUT;
+                fds.push_back({entry.first, events, 0});
+            }
+
+            int events = poll(fds.data(), fds.size(), wait ? -1 : 0);
+            if (events < 0) {
+                if (errno == EINTR) return 0;
+                perror("poll");
+                return -1;
+            }
+            if (events == 0) return 0; // Only without wait: nothing queued
+
+            if (fds[0].revents & POLLIN) {
+                int fd;
+                while ((fd = accept(listen_fd, nullptr, nullptr)) >= 0) {
+                    set_nonblocking(fd);
+                    conns[fd].fd = fd;
+                }
+            }
+
+            for (size_t i = 1; i < fds.size(); ++i) {
+                Connection& conn = conns[fds[i].fd];
+                if (fds[i].revents & POLLOUT) {
+                    if (!write_pending(conn, false)) {
+                        drop(conn.fd);
+                        continue;
+                    }
+                }
+                if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                    bool open = read_available(conn);
+                    size_t before = ready.size();
+                    parse_frames(conn, ready);
+                    for (size_t f = before; f < ready.size(); ++f) {
+                        train_fd[ready[f].train_id] = conn.fd; // replies go back where the train last spoke from
+                    }
+                    if (!open) drop(conn.fd);
+                }
+            }
+        }
+
+        msg = ready.front();
+        ready.pop_front();
+        return 1;
+    }
+
+    void send(const TrainMessage& msg) override {
+        auto it = train_fd.find(msg.train_id);
+        if (it == train_fd.end()) {
+            std::cerr << "Error: No connection for Train " << msg.train_id << std::endl;
+            return;
+        }
+        conns[it->second].out.append((const char*)&msg, FRAME_SIZE);
+    }
+
+    void flush() override {
+        std::vector<int> broken;
+        for (auto& entry : conns) {
+            if (!entry.second.out.empty() && !write_pending(entry.second, false)) {
+                broken.push_back(entry.first);
+            }
+        }
+        for (int fd : broken) drop(fd);
+    }
+
+    // Frames read but not handed back yet; the rest is still in the socket buffers
+    long queue_depth() override {
+        return ready.size();
+    }
+
+private:
+    int listen_fd;
+    std::map<int, Connection> conns;
+    std::unordered_map<int, int> train_fd;
+    std::deque<TrainMessage> ready;
+
+    void drop(int fd) {
+        close(fd);
+        conns.erase(fd);
+        for (auto it = train_fd.begin(); it != train_fd.end();) {
+            if (it->second == fd) it = train_fd.erase(it);
+            else ++it;
+        }
+    }
+};
+
+class SocketTrain : public TrainTransport {
+public:
+    explicit SocketTrain(const TransportConfig& config) : config(config), shards(config.num_shards) {}
+
+    ~SocketTrain() override {
+        flush();
+        for (Connection& conn : shards) {
+            if (conn.fd >= 0) close(conn.fd);
+        }
+    }
+
+    void send(const TrainMessage& msg) override {
+        Connection* conn = shard(shard_of(msg.intersection, config.num_shards));
+        if (conn) conn->out.append((const char*)&msg, FRAME_SIZE);
+    }
+
+    bool receive(int train_id, TrainMessage& msg) override {
+        flush();
+        while (true) {
+            for (Connection& conn : shards) {
+                if (conn.fd >= 0) parse_frames(conn, replies);
+            }
+            while (!replies.empty()) {
+                msg = replies.front();
+                replies.pop_front();
+                if (msg.train_id == train_id) return true;
+            }
+
+            std::vector<pollfd> fds;
+            for (Connection& conn : shards) {
+                if (conn.fd >= 0) fds.push_back({conn.fd, POLLIN, 0});
+            }
+            if (fds.empty()) return false;
+            if (poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            for (Connection& conn : shards) {
+                if (conn.fd < 0) continue;
+                if (!read_available(conn)) {
+                    parse_frames(conn, replies);
+                    close(conn.fd);
+                    conn.fd = -1;
+                }
+            }
+        }
+    }
+
+    void flush() override {
+        for (Connection& conn : shards) {
+            if (conn.fd >= 0 && !conn.out.empty()) write_pending(conn, true);
+        }
+    }
+
+    void send_control(const char* command) override {
+        TrainMessage control_msg;
+        memset(&control_msg, 0, sizeof(control_msg));
+        control_msg.type = REQUEST_TYPE;
+        strncpy(control_msg.command, command, sizeof(control_msg.command) - 1);
+        for (int s = 0; s < config.num_shards; ++s) {
+            Connection* conn = shard(s);
+            if (!conn) continue;
+            conn->out.append((const char*)&control_msg, FRAME_SIZE);
+        }
+        flush();
+    }
+
+    // A full socket buffer blocks the flush instead, which is TCP's own flow control
+    long full_retries() override {
+        return 0;
+    }
+
+private:
+    TransportConfig config;
+    std::vector<Connection> shards;
+    std::deque<TrainMessage> replies;
+
+    // Connects to a shard the first time a route needs it
+    Connection* shard(int s) {
+        if (shards[s].fd < 0) {
+            shards[s].fd = connect_to(config, s);
+            if (shards[s].fd < 0) return nullptr;
+        }
+        return &shards[s];
+    }
+};
+
+ServerTransport* open_server_transport(const TransportConfig& config, int shard) {
+    if (config.kind == TRANSPORT_MSGQUEUE) return new MsgQueueServer(config.msgid);
+    return new SocketServer(config, shard);
+}
+
+TrainTransport* open_train_transport(const TransportConfig& config) {
+    if (config.kind == TRANSPORT_MSGQUEUE) return new MsgQueueTrain(config.msgid);
+    return new SocketTrain(config);
+}
@@ -0,0 +1,90 @@
+// Group : I
+// Author: Wyatt Probst
+// Date: 10/19/2026
+// Description: Declares the train <-> server transports. The same TrainMessage protocol runs over the SysV message
+// queue (single host) or over TCP / Unix stream sockets, optionally split across several server shards.
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include "message.h"
+
+enum TransportKind {
+    TRANSPORT_MSGQUEUE, // the run's private SysV queue, one host
+    TRANSPORT_TCP,      // shard s listens on host:port+s
+    TRANSPORT_UNIX      // shard s listens on path.s
+};
+
+struct TransportConfig {
+    TransportKind kind = TRANSPORT_MSGQUEUE;
+    std::string host = "127.0.0.1";
+    int port = 7000;
+    std::string path = "/tmp/trainsim.sock";
+    int num_shards = 1;
+    int msgid = -1;     // private queue created by main before forking
+};
+
+// Parses "msgq", "tcp:HOST:PORT" or "unix:PATH". Returns false on a bad spec.
+bool parse_transport(const std::string& spec, TransportConfig& config);
+
+std::string describe_transport(const TransportConfig& config);
+
+// Shard that owns an intersection. Stable across processes and hosts (FNV-1a of the name).
+int shard_of(const std::string& intersection, int num_shards);
+
+// Exponential backoff with full jitter: floor_ms plus a random delay of up to
+// BACKOFF_BASE_MS doubled per attempt, capped at BACKOFF_MAX_MS
+#define BACKOFF_BASE_MS 2
+#define BACKOFF_MAX_MS 1000
+long backoff_ms(int attempt, long floor_ms);
+
+// Server side of the protocol
+class ServerTransport {
+public:
+    virtual ~ServerTransport() {}
+
+    // Blocks for the next request. Returns 1 with msg filled in, 0 if interrupted by a
+    // signal before a request arrived (or, with wait false, if none is queued), -1 on a
+    // fatal error. Buffered replies are written out whenever there is no request left to
+    // hand back, so replies to a burst of pipelined requests go out together.
+    virtual int receive(TrainMessage& msg, bool wait = true) = 0;
+
+    // Queues a reply for msg.train_id
+    virtual void send(const TrainMessage& msg) = 0;
+
+    // Writes out every queued reply
+    virtual void flush() = 0;
+
+    // Messages waiting to be received. The SysV queue also counts replies not yet picked
+    // up, since they fill the same byte limit (msgmnb) that requests do.
+    virtual long queue_depth() = 0;
+};
+
+// Train side of the protocol
+class TrainTransport {
+public:
+    virtual ~TrainTransport() {}
+
+    // Queues a request for the shard owning msg.intersection. Requests are pipelined:
+    // nothing is written until flush() or receive().
+    virtual void send(const TrainMessage& msg) = 0;
+
+    // Flushes queued requests, then blocks for the next reply addressed to train_id
+    virtual bool receive(int train_id, TrainMessage& msg) = 0;
+
+    virtual void flush() = 0;
+
+    // Sends a control command ("shutdown", "reload") to every shard
+    virtual void send_control(const char* command) = 0;
+
+    // Times a send found the request queue full and backed off instead of blocking
+    virtual long full_retries() = 0;
+};
+
+ServerTransport* open_server_transport(const TransportConfig& config, int shard);
+TrainTransport* open_train_transport(const TransportConfig& config);
+
+#endif // TRANSPORT_H
@@ -0,0 +1,151 @@
+// Group : I
+// Author: Brandon Collings
+// Email: brandon.l.collings@okstate.edu
+// Date: 10/19/2026
+// Description: Implements the work-stealing executor.
+
+#include "work_stealing.h"
+#include <chrono>
+
+// Which pool and worker the calling thread belongs to
+static thread_local const WorkStealingPool* current_pool = nullptr;
+static thread_local int current_index = -1;
+
+static long steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t xorshift(uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+WorkStealingPool::WorkStealingPool(int num_threads, unsigned seed)
+    : num_threads(num_threads < 1 ? 1 : num_threads), workers(new Worker[this->num_threads]),
+      queued(0), outstanding(0), sleepers(0), next_deque(0), stopping(false)
+{
+    for (int w = 0; w < this->num_threads; ++w) {
+        workers[w].rng = 0x9e3779b97f4a7c15ull * (seed + w + 1);
+    }
+    for (int w = 0; w < this->num_threads; ++w) {
+        threads.emplace_back(&WorkStealingPool::worker_loop, this, w);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    work_cv.notify_all();
+    for (std::thread& t : threads) {
+        t.join();
+    }
+}
+
+int WorkStealingPool::current_worker() const {
+    return current_pool == this ? current_index : -1;
+}
+
+void WorkStealingPool::submit(Task task) {
+    int w = current_worker();
+    if (w < 0) w = next_deque++ % num_threads;
+    outstanding++;
+    {
+        std::lock_guard<std::mutex> lock(workers[w].mutex);
+        workers[w].tasks.push_back(std::move(task));
+    }
+    // A worker counts itself asleep before it checks queued, so one of the two always sees the other
+    queued++;
+    if (sleepers > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        work_cv.notify_one();
+    }
+}
+
+void WorkStealingPool::wait_idle() {
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    idle_cv.wait(lock, [&] { return outstanding == 0; });
+}
+
+// Own deque from the back, then every other deque from the front, starting at a random victim
+bool WorkStealingPool::take(int worker, Task& task) {
+    Worker& self = workers[worker];
+    {
+        std::lock_guard<std::mutex> lock(self.mutex);
+        if (!self.tasks.empty()) {
+            task = std::move(self.tasks.back());
+            self.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    if (num_threads == 1) return false;
+
+    int start = xorshift(self.rng) % num_threads;
+    for (int i = 0; i < num_threads; ++i) {
+        int victim = (start + i) % num_threads;
+        if (victim == worker) continue;
+        Worker& other = workers[victim];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (!other.tasks.empty()) {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            queued--;
+            self.steals++;
+            return true;
+        }
+    }
+    self.failed_steals++;
+    return false;
+}
+
+void WorkStealingPool::worker_loop(int worker) {
+    current_pool = this;
+    current_index = worker;
+    Worker& self = workers[worker];
+    while (true) {
+        Task task;
+        if (take(worker, task)) {
+            task();
+            self.ran++;
+            if (--outstanding == 0) {
+                std::lock_guard<std::mutex> lock(sleep_mutex);
+                idle_cv.notify_all();
+            }
+            continue;
+        }
+
+        long start = steady_ns();
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleepers++;
+        work_cv.wait(lock, [&] { return stopping || queued > 0; });
+        sleepers--;
+        self.idle_ns += steady_ns() - start;
+        if (stopping && queued == 0) return;
+    }
+}
+
+WorkStealingPool::Counters WorkStealingPool::counters(int worker) const {
+    Counters c;
+    c.tasks = workers[worker].ran;
+    c.steals = workers[worker].steals;
+    c.failed_steals = workers[worker].failed_steals;
+    c.idle_ns = workers[worker].idle_ns;
+    return c;
+}
+
+WorkStealingPool::Counters WorkStealingPool::total() const {
+    Counters sum;
+    for (int w = 0; w < num_threads; ++w) {
+        Counters c = counters(w);
+        sum.tasks += c.tasks;
+        sum.steals += c.steals;
+        sum.failed_steals += c.failed_steals;
+        sum.idle_ns += c.idle_ns;
+    }
+    return sum;
+}
@@ -0,0 +1,80 @@
+// Group : I
+// Author: Brandon Collings
+// Email: brandon.l.collings@okstate.edu
+// Date: 10/19/2026
+// Description: Declares a work-stealing executor for in-process train steps and server shard work, where
+// tasks differ too much in length for the fixed chunks of ThreadPool.
+
+#ifndef WORK_STEALING_H
+#define WORK_STEALING_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+// Every worker has its own deque. It pushes and pops its own tasks at the back, so a train step
+// that schedules the next one keeps running on the same core, and an idle worker steals from the
+// front of a randomly chosen victim. Like ThreadPool, create it after fork(), never before.
+class WorkStealingPool {
+public:
+    typedef std::function<void()> Task;
+
+    struct Counters {
+        long tasks = 0;
+        long steals = 0;         // tasks taken from another worker's deque
+        long failed_steals = 0;  // rounds over every other deque that found nothing
+        long idle_ns = 0;        // time spent asleep waiting for work
+    };
+
+    explicit WorkStealingPool(int num_threads, unsigned seed = 1);
+    ~WorkStealingPool();
+
+    int size() const { return num_threads; }
+
+    // On a worker the task goes on that worker's own deque; from any other thread the
+    // deques are dealt round-robin
+    void submit(Task task);
+
+    // Blocks until every task submitted so far, and every task they submit, has run
+    void wait_idle();
+
+    // Index of the calling worker, or -1 outside the pool
+    int current_worker() const;
+
+    Counters counters(int worker) const;
+    Counters total() const;
+
+private:
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        uint64_t rng = 0;        // victim choice, only touched by the worker itself
+        std::atomic<long> ran{0};
+        std::atomic<long> steals{0};
+        std::atomic<long> failed_steals{0};
+        std::atomic<long> idle_ns{0};
+    };
+
+    int num_threads;
+    std::unique_ptr<Worker[]> workers;
+    std::vector<std::thread> threads;
+    std::atomic<long> queued;       // tasks sitting in some deque
+    std::atomic<long> outstanding;  // submitted and not finished
+    std::atomic<int> sleepers;
+    std::atomic<unsigned> next_deque;
+    std::mutex sleep_mutex;
+    std::condition_variable work_cv;
+    std::condition_variable idle_cv;
+    bool stopping;
+
+    void worker_loop(int worker);
+    bool take(int worker, Task& task);
+};
+
+#endif // WORK_STEALING_H